@@ -0,0 +1,34 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "types.h"
+#include "config.h"
+
+// FUNCTIONS IMPLEMENTED HERE FOR INLINING
+// The stores complete once the whole cache is walked, they do nothing when
+// the core is built without data cache. The fence keeps later loads from
+// passing them in the store buffer
+
+#define DCACHE_CLEAN 0b01
+#define DCACHE_INVALIDATE 0b10
+#define DCACHE_FLUSH (DCACHE_CLEAN | DCACHE_INVALIDATE)
+
+// Writes dirty data cache lines back to memory, lines stay valid
+inline void dcache_clean() {
+    DCACHE_CTRL_REG = DCACHE_CLEAN;
+    asm volatile("fence" ::: "memory");
+}
+
+// Drops all data cache lines, dirty data is lost
+inline void dcache_invalidate() {
+    DCACHE_CTRL_REG = DCACHE_INVALIDATE;
+    asm volatile("fence" ::: "memory");
+}
+
+// Writes dirty lines back and drops all data cache lines
+inline void dcache_flush() {
+    DCACHE_CTRL_REG = DCACHE_FLUSH;
+    asm volatile("fence" ::: "memory");
+}
+
+#endif
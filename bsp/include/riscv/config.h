@@ -7,6 +7,11 @@
 
 // Profiler internal counters
 #define NUM_PROFILER_COUNTERS 8
+// Profiler internal start/stop event log size
+#define NUM_PROFILER_EVENTS 256
+
+// Hardware performance monitor counters of the core, RV32_HPM_COUNTERS
+#define NUM_HPM_COUNTERS 2
 
 // mtimer MMIO 
 #define MTIMER_BASE_ADDR 0x10500000
@@ -25,5 +30,13 @@
 #define PROFILER_BASE_ADDR 0x10700000
 #define PROFILER_COUNTER_START *((volatile uint8_t *) PROFILER_BASE_ADDR)
 #define PROFILER_COUNTER_STOP *((volatile uint8_t *) (PROFILER_BASE_ADDR + 1))
+#define PROFILER_REGION_START *((volatile uint16_t *) (PROFILER_BASE_ADDR + 4))
+#define PROFILER_REGION_STOP *((volatile uint16_t *) (PROFILER_BASE_ADDR + 8))
+#define PROFILER_REGION_NAME_ID *((volatile uint16_t *) (PROFILER_BASE_ADDR + 12))
+#define PROFILER_REGION_NAME_CHAR *((volatile uint8_t *) (PROFILER_BASE_ADDR + 16))
+
+// Data cache control MMIO, see cache.h
+#define DCACHE_CTRL_ADDR 0x10800000
+#define DCACHE_CTRL_REG *((volatile uint32_t *) DCACHE_CTRL_ADDR)
 
 #endif
@@ -2,6 +2,7 @@
 #define CSR_H
 
 #include "types.h"
+#include "config.h"
 
 // mcause values
 #define MCAUSE_MISALIGNED_FETCH      0x0
@@ -69,6 +70,7 @@ inline uint32 read_mepc() {
 // mcountinhibit bits
 #define MCYCLE_BIT      (1)
 #define MINSTRET_BIT    (1 << 2)
+#define MHPMCOUNTER_BITS (((1 << NUM_HPM_COUNTERS) - 1) << 3)
 
 inline void set_mcountinhibit(uint32 mask) {
     asm volatile("csrs mcountinhibit, %0" :: "r" (mask));
@@ -79,23 +81,40 @@ inline void clear_mcountinhibit(uint32 mask) {
 }
 
 // Utility functions for disable/enable the hw counters
-// 2 cycles overhead
+// HW_COUNTERS_OVERHEAD cycles and instructions, 1 while the mask fits the
+// csr immediate
+
+#define HW_COUNTERS_MASK (MCYCLE_BIT | MINSTRET_BIT | MHPMCOUNTER_BITS)
+
+#if NUM_HPM_COUNTERS <= 2
+#define HW_COUNTERS_OVERHEAD 1
+
+inline void disable_hw_counters() {
+    asm volatile("csrsi mcountinhibit, %0" :: "i" (HW_COUNTERS_MASK));
+}
+
+inline void enable_hw_counters() {
+    asm volatile("csrci mcountinhibit, %0" :: "i" (HW_COUNTERS_MASK));
+}
+#else
+#define HW_COUNTERS_OVERHEAD 2
 
 inline void disable_hw_counters() {
     asm volatile(
-        "li x31, 5\n"
+        "li x31, %0\n"
         "csrs mcountinhibit, x31"
-        ::: "x31"
+        :: "i" (HW_COUNTERS_MASK) : "x31"
     );
 }
 
 inline void enable_hw_counters() {
     asm volatile(
-        "li x31, 5\n"
+        "li x31, %0\n"
         "csrc mcountinhibit, x31"
-        ::: "x31"
+        :: "i" (HW_COUNTERS_MASK) : "x31"
     );
 }
+#endif
 
 inline uint64 read_mcycle() {
     uint32 cl, ch;
@@ -121,6 +140,69 @@ inline uint64 read_instret() {
     return ((uint64) ih << 32) | il;
 }
 
+// Hardware performance monitor
+// mhpmcounter3 up to 3 + NUM_HPM_COUNTERS - 1 count the event selected by
+// their mhpmevent, writes of other values select HPM_EVENT_NONE
+#define HPM_EVENT_NONE          0
+// Cycles decode sends a bubble for a load use
+#define HPM_EVENT_LOAD_USE      1
+// Cycles the memory stage stalls
+#define HPM_EVENT_MEM_STALL     2
+// Mispredicted branches/jumps, exec flushes fetch and decode
+#define HPM_EVENT_BRANCH_FLUSH  3
+// Taken branches/jumps
+#define HPM_EVENT_BRANCH_TAKEN  4
+// Loads and stores
+#define HPM_EVENT_LOAD_STORE    5
+// MUL and GRNG instructions
+#define HPM_EVENT_MUL_GRNG      6
+
+// CSR names are part of the instruction, one case per counter n, 3 to 8
+#define HPM_CASES(X) X(3) X(4) X(5) X(6) X(7) X(8)
+
+#define SET_MHPMEVENT_CASE(i) \
+    case i: asm volatile("csrw mhpmevent" #i ", %0" :: "r" (event)); break;
+
+#define READ_MHPMCOUNTER_CASE(i) \
+    case i: \
+        asm volatile( \
+            "csrr %0, mhpmcounter" #i "\n" \
+            "csrr %1, mhpmcounter" #i "h" \
+            : "=r" (l), "=r" (h) \
+        ); \
+        break;
+
+#define RESET_MHPMCOUNTER_CASE(i) \
+    case i: \
+        asm volatile( \
+            "csrw mhpmcounter" #i ", x0\n" \
+            "csrw mhpmcounter" #i "h, x0" \
+        ); \
+        break;
+
+inline void set_mhpmevent(const uint8 n, const uint32 event) {
+    switch (n) {
+        HPM_CASES(SET_MHPMEVENT_CASE)
+        default: break;
+    }
+}
+
+inline uint64 read_mhpmcounter(const uint8 n) {
+    uint32 l = 0, h = 0;
+    switch (n) {
+        HPM_CASES(READ_MHPMCOUNTER_CASE)
+        default: break;
+    }
+    return ((uint64) h << 32) | l;
+}
+
+inline void reset_mhpmcounter(const uint8 n) {
+    switch (n) {
+        HPM_CASES(RESET_MHPMCOUNTER_CASE)
+        default: break;
+    }
+}
+
 inline void read_hw_counters(uint64* cycles, uint64* instr) {
     uint32 cl, ch, il, ih;
 
@@ -12,4 +12,23 @@ inline void stop_external_counter(const uint8 id) {
     PROFILER_COUNTER_STOP = id;
 }
 
+// 16 bit id regions, share the id space with the 8 bit counters
+// Regions can be nested and recursive, each stop closes the last
+// start of the same id
+
+inline void start_external_region(const uint16 id) {
+    PROFILER_REGION_START = id;
+}
+
+inline void stop_external_region(const uint16 id) {
+    PROFILER_REGION_STOP = id;
+}
+
+// Name shown in the reports, sent 1 character per store
+inline void set_external_region_name(const uint16 id, const char* name) {
+    PROFILER_REGION_NAME_ID = id;
+    while (*name) PROFILER_REGION_NAME_CHAR = *name++;
+    PROFILER_REGION_NAME_CHAR = 0;
+}
+
 #endif
\ No newline at end of file
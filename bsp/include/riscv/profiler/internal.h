@@ -22,8 +22,31 @@ inline void stop_internal_counter(const uint8 id) {
     enable_hw_counters();
 }
 
+// Cycles counted by the counter
 uint64 get_internal_counter(const uint8 id);
 
+// Instructions retired while counting
+uint64 get_internal_counter_instret(const uint8 id);
+
+// Events of mhpmcounter n (3 up to 3 + NUM_HPM_COUNTERS - 1) while counting
+uint64 get_internal_counter_hpm(const uint8 id, const uint8 n);
+
 void reset_internal_counter(const uint8 id);
 
+// Event counted by mhpmcounter n for all the counters, HPM_EVENT_* of csr.h
+// Set it while no counter is started
+void set_internal_hpm_event(const uint8 n, const uint32 event);
+
+// Timeline of start/stop events
+// Events are logged with their mcycle value, up to NUM_PROFILER_EVENTS
+
+// Name shown for the counter in the timeline, the string is not copied
+void set_internal_counter_name(const uint8 id, const char* name);
+
+// Prints the logged events as Chrome trace-event JSON
+void print_internal_timeline();
+
+// Clears the event log
+void reset_internal_timeline();
+
 #endif
@@ -1,6 +1,8 @@
 #include <riscv/profiler/internal.h>
 #include <riscv/csr.h>
 
+#include <stdio.h>
+
 uint64 counters[NUM_PROFILER_COUNTERS] = {
     0
 };
@@ -10,12 +12,57 @@ uint64 counters_starts[NUM_PROFILER_COUNTERS] = {
 uint32 times_started[NUM_PROFILER_COUNTERS] = {
     0
 };
+const char* counters_names[NUM_PROFILER_COUNTERS] = {
+    NULL
+};
+uint64 counters_instret[NUM_PROFILER_COUNTERS] = {
+    0
+};
+uint64 counters_instret_starts[NUM_PROFILER_COUNTERS] = {
+    0
+};
+#if NUM_HPM_COUNTERS > 0
+uint64 counters_hpm[NUM_PROFILER_COUNTERS][NUM_HPM_COUNTERS] = {
+    {0}
+};
+uint64 counters_hpm_starts[NUM_PROFILER_COUNTERS][NUM_HPM_COUNTERS] = {
+    {0}
+};
+#endif
+
+typedef struct {
+    uint64 cycle;
+    uint8 id;
+    uint8 start;
+} profiler_event;
+
+profiler_event events[NUM_PROFILER_EVENTS];
+uint32 num_events = 0;
+uint32 dropped_events = 0;
+
+static void log_event(const uint8 id, const uint8 start, const uint64 cycle) {
+    if (num_events >= NUM_PROFILER_EVENTS) {
+        dropped_events++;
+        return;
+    }
+    events[num_events].cycle = cycle;
+    events[num_events].id = id;
+    events[num_events].start = start;
+    num_events++;
+}
 
 void _start_internal_counter(const uint8 id) {
     // Error counter does not exist
     if (id >= NUM_PROFILER_COUNTERS) return;
 
     counters_starts[id] = read_mcycle();
+    counters_instret_starts[id] = read_instret();
+#if NUM_HPM_COUNTERS > 0
+    for (uint8 k = 0; k < NUM_HPM_COUNTERS; k++) {
+        counters_hpm_starts[id][k] = read_mhpmcounter(3 + k);
+    }
+#endif
+    log_event(id, 1, counters_starts[id]);
 }
 
 void _stop_internal_counter(const uint8 id) {
@@ -23,8 +70,16 @@ void _stop_internal_counter(const uint8 id) {
     if (id >= NUM_PROFILER_COUNTERS) return;
 
     // Only required at stop because those are counted after the start
-    // -2 overhead cycles of disabling the hw counter
-    counters[id] += read_mcycle() - 2 - counters_starts[id];
+    // Overhead cycles and instructions of disabling the hw counters
+    uint64 stop = read_mcycle() - HW_COUNTERS_OVERHEAD;
+    counters[id] += stop - counters_starts[id];
+    counters_instret[id] += read_instret() - HW_COUNTERS_OVERHEAD - counters_instret_starts[id];
+#if NUM_HPM_COUNTERS > 0
+    for (uint8 k = 0; k < NUM_HPM_COUNTERS; k++) {
+        counters_hpm[id][k] += read_mhpmcounter(3 + k) - counters_hpm_starts[id][k];
+    }
+#endif
+    log_event(id, 0, stop);
 }
 
 uint64 get_internal_counter(const uint8 id) {
@@ -34,9 +89,101 @@ uint64 get_internal_counter(const uint8 id) {
     return counters[id];
 }
 
+uint64 get_internal_counter_instret(const uint8 id) {
+    // Error counter does not exist
+    if (id >= NUM_PROFILER_COUNTERS) return 0;
+
+    return counters_instret[id];
+}
+
+uint64 get_internal_counter_hpm(const uint8 id, const uint8 n) {
+    // Error counter does not exist
+    if (id >= NUM_PROFILER_COUNTERS) return 0;
+    if (n < 3 || n >= 3 + NUM_HPM_COUNTERS) return 0;
+
+#if NUM_HPM_COUNTERS > 0
+    return counters_hpm[id][n - 3];
+#else
+    return 0;
+#endif
+}
+
 void reset_internal_counter(const uint8 id) {
     // Error counter does not exist
     if (id >= NUM_PROFILER_COUNTERS) return;
 
     counters[id] = 0;
+    counters_instret[id] = 0;
+#if NUM_HPM_COUNTERS > 0
+    for (uint8 k = 0; k < NUM_HPM_COUNTERS; k++) counters_hpm[id][k] = 0;
+#endif
+}
+
+void set_internal_hpm_event(const uint8 n, const uint32 event) {
+    // Error hpm counter does not exist
+    if (n < 3 || n >= 3 + NUM_HPM_COUNTERS) return;
+
+    set_mhpmevent(n, event);
+}
+
+void set_internal_counter_name(const uint8 id, const char* name) {
+    // Error counter does not exist
+    if (id >= NUM_PROFILER_COUNTERS) return;
+
+    counters_names[id] = name;
+}
+
+void reset_internal_timeline() {
+    num_events = 0;
+    dropped_events = 0;
+}
+
+// printf may lack 64 bit support, print as 2 decimal parts
+static void print_uint64(uint64 v) {
+    uint32 hi = v / 1000000000;
+    uint32 lo = v % 1000000000;
+    if (hi) printf("%lu%09lu", hi, lo);
+    else printf("%lu", lo);
+}
+
+// Same format as the harness -pt output, "ts" are cycles
+// Starts of the same id are stacked to match recursive regions
+void print_internal_timeline() {
+    uint32 open_starts[NUM_PROFILER_EVENTS];
+    uint32 num_open = 0;
+    uint8 first = 1;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for (uint32 i = 0; i < num_events; i++) {
+        if (events[i].start) {
+            open_starts[num_open++] = i;
+            continue;
+        }
+
+        // Find last open start of the same id
+        uint32 j = num_open;
+        while (j > 0 && events[open_starts[j - 1]].id != events[i].id) j--;
+        // Stop without start, ignore it
+        if (j == 0) continue;
+
+        const profiler_event* s = &events[open_starts[j - 1]];
+        for (; j < num_open; j++) open_starts[j - 1] = open_starts[j];
+        num_open--;
+
+        printf(first ? "\n" : ",\n");
+        first = 0;
+        if (counters_names[s->id] != NULL) {
+            printf("{\"name\":\"%s\"", counters_names[s->id]);
+        } else {
+            printf("{\"name\":\"Counter %u\"", s->id);
+        }
+        printf(",\"cat\":\"profiler\",\"ph\":\"X\",\"ts\":");
+        print_uint64(s->cycle);
+        printf(",\"dur\":");
+        print_uint64(events[i].cycle - s->cycle);
+        printf(",\"pid\":0,\"tid\":0,\"args\":{\"id\":%u}}", s->id);
+    }
+
+    printf("\n],\"otherData\":{\"dropped_events\":%lu}}\n", dropped_events);
 }
@@ -0,0 +1,158 @@
+/* verilator lint_off UNUSEDSIGNAL */
+
+/*
+ Dynamic branch predictor
+ - Direct mapped branch target buffer
+ - Bimodal or gshare 2-bit counters for conditional branches
+ - Return address stack
+ The pc requested by fetch is looked up every cycle, exec resolves every
+ branch/jump and trains the tables with the outcome. The global history
+ and the tables are only updated by resolved instructions, the return
+ address stack is updated speculatively when fetch advances and is not
+ repaired after a mispredict
+*/
+
+module rv32_branch_predictor
+import rv32_types::*;
+#(
+    parameter int SCHEME = BRANCH_PREDICTOR,
+    parameter int NUM_BTB = BTB_ENTRIES,
+    parameter int NUM_BHT = BHT_ENTRIES,
+    parameter int HISTORY_BITS = BP_HISTORY_BITS,
+    parameter int NUM_RAS = RAS_ENTRIES
+) (
+    input logic clk, resetn,
+    // Fetch lookup
+    input rv32_word pc,
+    input logic fetch_advance,
+    output branch_prediction_t prediction,
+    // Exec resolution
+    input branch_resolution_t resolution
+);
+
+localparam int BTB_BITS = $clog2(NUM_BTB);
+localparam int BHT_BITS = $clog2(NUM_BHT);
+localparam int RAS_BITS = $clog2(NUM_RAS);
+localparam int TAG_BITS = 30 - BTB_BITS;
+
+// Branch target buffer
+logic [NUM_BTB-1:0] btb_valid;
+logic [TAG_BITS-1:0] btb_tag [NUM_BTB];
+rv32_word btb_target [NUM_BTB];
+btb_kind_t btb_kind [NUM_BTB];
+
+// Direction counters and global history
+logic [1:0] bht [NUM_BHT];
+logic [HISTORY_BITS-1:0] history;
+
+// Return address stack
+rv32_word ras [NUM_RAS];
+logic [RAS_BITS-1:0] ras_top;
+logic [RAS_BITS:0] ras_count;
+
+// Performance counters, resolved branches/jumps predicted right or wrong
+logic [63:0] hits /*verilator public*/;
+logic [63:0] misses /*verilator public*/;
+
+function automatic logic [BHT_BITS-1:0] bht_index(
+    input rv32_word addr, input logic [HISTORY_BITS-1:0] h
+);
+    logic [BHT_BITS-1:0] index, global_history;
+    index = addr[2 +: BHT_BITS];
+    global_history = 0;
+    global_history[HISTORY_BITS-1:0] = h;
+    if (SCHEME == BP_GSHARE) index = index ^ global_history;
+    return index;
+endfunction
+
+// Lookup
+logic [BTB_BITS-1:0] lookup_index;
+logic lookup_hit;
+logic [BHT_BITS-1:0] lookup_bht_index;
+always_comb begin
+    lookup_index = pc[2 +: BTB_BITS];
+    lookup_hit = btb_valid[lookup_index] &&
+        btb_tag[lookup_index] == pc[31 -: TAG_BITS];
+    lookup_bht_index = bht_index(pc, history);
+
+    prediction = create_not_taken_prediction();
+    prediction.target = btb_target[lookup_index];
+    prediction.bht_index[BHT_BITS-1:0] = lookup_bht_index;
+
+    if (SCHEME != BP_NONE && lookup_hit) begin
+        case (btb_kind[lookup_index])
+            BTB_BRANCH: prediction.taken = bht[lookup_bht_index][1];
+            BTB_RET: begin
+                prediction.taken = 1;
+                if (ras_count != 0) prediction.target = ras[ras_top];
+            end
+            default: prediction.taken = 1;
+        endcase
+    end
+end
+
+// Speculative return address stack
+always_ff @(posedge clk) begin
+    if (!resetn) begin
+        ras_top <= 0;
+        ras_count <= 0;
+    end
+    else if (SCHEME != BP_NONE && fetch_advance && lookup_hit) begin
+        // Oldest entry is overwritten on overflow
+        if (btb_kind[lookup_index] == BTB_CALL) begin
+            ras[ras_top + 1'b1] <= pc + 4;
+            ras_top <= ras_top + 1'b1;
+            if (int'(ras_count) != NUM_RAS) ras_count <= ras_count + 1'b1;
+        end
+        else if (btb_kind[lookup_index] == BTB_RET && ras_count != 0) begin
+            ras_top <= ras_top - 1'b1;
+            ras_count <= ras_count - 1'b1;
+        end
+    end
+end
+
+// Training
+logic [BTB_BITS-1:0] update_index;
+logic [BHT_BITS-1:0] update_bht_index;
+always_comb begin
+    update_index = resolution.pc[2 +: BTB_BITS];
+    update_bht_index = resolution.bht_index[BHT_BITS-1:0];
+end
+
+always_ff @(posedge clk) begin
+    if (!resetn) begin
+        btb_valid <= 0;
+        history <= 0;
+        hits <= 0;
+        misses <= 0;
+        // Weakly not taken
+        bht <= '{default: 2'b01};
+    end
+    else if (resolution.valid) begin
+        if (resolution.mispredict) misses <= misses + 1;
+        else hits <= hits + 1;
+
+        if (resolution.control_flow) begin
+            if (resolution.conditional) begin
+                if (resolution.taken && bht[update_bht_index] != 2'b11)
+                    bht[update_bht_index] <= bht[update_bht_index] + 1;
+                if (!resolution.taken && bht[update_bht_index] != 2'b00)
+                    bht[update_bht_index] <= bht[update_bht_index] - 1;
+                history <= {history[HISTORY_BITS-2:0], resolution.taken};
+            end
+
+            // Only taken branches are allocated
+            if (resolution.taken) begin
+                btb_valid[update_index] <= 1;
+                btb_tag[update_index] <= resolution.pc[31 -: TAG_BITS];
+                btb_target[update_index] <= resolution.target;
+                btb_kind[update_index] <= resolution.kind;
+            end
+        end
+
+        // Stale entry of an instruction that is not a branch anymore
+        else if (resolution.mispredict) btb_valid[update_index] <= 0;
+    end
+end
+
+endmodule
@@ -1,13 +1,26 @@
 /* verilator lint_off UNUSEDSIGNAL */
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off WIDTHEXPAND */
 
-/* 
+/*
  CPU 1 fetch stage
  - Instruction fetch
+ - Branch prediction of the fetched pc
+ - Instruction queue
+*/
+
+/*
+ Without queue fetch stops when decode stalls and the fetched instruction
+ goes to decode the next cycle. With queue fetch keeps requesting while
+ there is room, the fetched instructions that decode cannot take wait in
+ the queue and a redirect flushes it
 */
 
 module rv32_fetch_stage
 import rv32_types::*;
-(
+#(
+    parameter int QUEUE_ENTRIES = FETCH_QUEUE
+) (
     // Clk, Reset signals
     input logic clk, resetn,
 
@@ -17,46 +30,131 @@ import rv32_types::*;
     input rv32_word set_nop_pc,
 
     input rv32_word pc,
+    input branch_prediction_t prediction,
+    // Instruction request not done or not sent, pc is held
     output logic stall,
+    // Request accepted, the prediction of pc is used
+    output logic advance,
+    // Decode gets a bubble the next cycle
+    output logic bubble,
     output fetch_decode_buffer_t fetch_decode_buff,
+    output rv_instr_t decode_instr,
 
     // Bus I/O
     output memory_request_t instr_request,
-    input logic request_done
+    input logic request_done,
+    input rv_instr_t instr
 );
 
+localparam int DEPTH = QUEUE_ENTRIES > 0 ? QUEUE_ENTRIES : 1;
+localparam int COUNT_BITS = $clog2(DEPTH + 1);
+localparam int PTR_BITS = DEPTH > 1 ? $clog2(DEPTH) : 1;
+
 fetch_decode_buffer_t internal_data;
 
+// Instruction served last cycle, its word is on the instr input
+fetch_decode_buffer_t response;
+
+// Queue
+fetch_decode_buffer_t queue [DEPTH];
+rv_instr_t queue_instr [DEPTH];
+logic [PTR_BITS-1:0] head, tail;
+logic [COUNT_BITS-1:0] count;
+
+logic fetch_stop, consume, push, pop;
 always_comb begin
-    if (stop) instr_request.op = MEM_NOP;
+    if (QUEUE_ENTRIES == 0) begin
+        fetch_stop = stop;
+        consume = 0;
+        push = 0;
+        pop = 0;
+    end
+    else begin
+        // Decode takes the head, or the response when the queue is empty
+        consume = !stop && (count != 0 || !response.generate_nop);
+        pop = consume && count != 0;
+        push = !response.generate_nop && !(consume && count == 0);
+        // Room for the instruction requested this cycle
+        fetch_stop = int'(count) + !response.generate_nop - consume >= DEPTH;
+    end
+
+    if (fetch_stop) instr_request.op = MEM_NOP;
     else instr_request.op = MEM_LW;
 
     instr_request.addr = pc;
     instr_request.data = 0;
-    stall = ~request_done;
+    advance = !fetch_stop && request_done;
+    stall = ~request_done || (QUEUE_ENTRIES != 0 && fetch_stop);
+
+    if (QUEUE_ENTRIES == 0) bubble = ~request_done;
+    else bubble = int'(count) - pop + push == 0 && !advance;
+
+    // Decode input
+    if (QUEUE_ENTRIES == 0) begin
+        fetch_decode_buff = response;
+        decode_instr = instr;
+    end
+    else if (count != 0) begin
+        fetch_decode_buff = queue[head];
+        decode_instr = queue_instr[head];
+    end
+    else begin
+        fetch_decode_buff = response;
+        decode_instr = instr;
+    end
 end
 
 always_ff @(posedge clk) begin
     if (!resetn) begin
-        fetch_decode_buff.pc <= 0;
-        fetch_decode_buff.generate_nop <= 1;
+        response.pc <= 0;
+        response.generate_nop <= 1;
+        response.prediction <= create_not_taken_prediction();
+        head <= 0;
+        tail <= 0;
+        count <= 0;
     end
 
     // A instruction is flushing the pipeline
     else if (set_nop) begin
-        fetch_decode_buff.pc <= set_nop_pc;
-        fetch_decode_buff.generate_nop <= 1;
+        response.pc <= set_nop_pc;
+        response.generate_nop <= 1;
+        response.prediction <= create_not_taken_prediction();
+        head <= 0;
+        tail <= 0;
+        count <= 0;
     end
 
     // Some instruction further in the pipeline is stalling do nothing
-    else if (!stop) begin
+    else if (!fetch_stop) begin
         // Memory request is done, new instruction fetched
         if (request_done) begin
-            fetch_decode_buff.pc <= pc;
-            fetch_decode_buff.generate_nop <= 0;
+            response.pc <= pc;
+            response.generate_nop <= 0;
+            response.prediction <= prediction;
+        end
+        // Slow instruction memory, decode gets a bubble
+        else begin
+            response.pc <= pc;
+            response.generate_nop <= 1;
+            response.prediction <= create_not_taken_prediction();
         end
     end
 
+    // Queue full, nothing requested
+    else if (QUEUE_ENTRIES != 0) begin
+        response.generate_nop <= 1;
+        response.prediction <= create_not_taken_prediction();
+    end
+
+    if (resetn && !set_nop && QUEUE_ENTRIES != 0) begin
+        if (push) begin
+            queue[tail] <= response;
+            queue_instr[tail] <= instr;
+            tail <= tail == DEPTH - 1 ? 0 : tail + 1'b1;
+        end
+        if (pop) head <= head == DEPTH - 1 ? 0 : head + 1'b1;
+        count <= count + push - pop;
+    end
 end
 
 endmodule
@@ -4,11 +4,14 @@
  CPU 2 decode stage
  - Decode
  - Data Hazzard detection
+ - Early jump resolution
 */
 
 module rv32_decode_stage
 import rv32_types::*;
-(
+#(
+    parameter int EARLY_JUMP_MODE = EARLY_JUMP
+) (
     // Clk, Reset signals
     input logic clk, resetn,
     // Pipeline I/O
@@ -17,6 +20,11 @@ import rv32_types::*;
     input fetch_decode_buffer_t fetch_decode_buff,
     output decode_exec_buffer_t decode_exec_buff,
     output logic stall,
+    // Stall cause, load use
+    output logic load_use_stall,
+    // Early jump, flushes fetch only
+    output logic do_jump,
+    output rv32_word jump_addr,
     // Memory I
     input rv_instr_t instr,
     // Register file data input
@@ -40,7 +48,9 @@ end
 
 logic use_rs [3] /*verilator public*/;
 bypass_t [2:0] bypass_rs;
+bypass_t bypass_csr;
 logic hazzard_stall;
+logic mul_use_stall /*verilator public*/;
 
 rv32_decoder decoder(
     .use_rs(use_rs),
@@ -55,15 +65,30 @@ rv32_hazzard_detection_unit hazzard_detection(
     .decode_exec_buff(decode_exec_buff),
     .exec_mem_buff(exec_mem_buff),
     .stall(hazzard_stall),
-    .bypass_rs(bypass_rs)
+    .load_use_stall(load_use_stall),
+    .mul_use_stall(mul_use_stall),
+    .bypass_rs(bypass_rs),
+    .bypass_csr(bypass_csr)
+);
+
+// Early jump target
+rv32_word immediate;
+rv32_immediate_gen immediate_gen(
+    .instr_type(decoder_output.t),
+    .instruction(internal_instr),
+    .immediate(immediate)
 );
 
 // Decode logic
 // Final stall control and register write
 always_comb begin
     // Forward signals
+    internal_data.valid = !fetch_decode_buff.generate_nop;
     internal_data.pc = fetch_decode_buff.pc;
     internal_data.instr = internal_instr;
+    internal_data.prediction = fetch_decode_buff.prediction;
+    if (fetch_decode_buff.generate_nop)
+        internal_data.prediction = create_not_taken_prediction();
 
     // Register file data
     internal_data.reg_data = reg_data;
@@ -73,6 +98,7 @@ always_comb begin
 
     // Hazard detection
     internal_data.control.bypass_rs = bypass_rs;
+    internal_data.control.bypass_csr = bypass_csr;
     stall = hazzard_stall;
 
     // If CSR instruction advance read csr
@@ -80,11 +106,30 @@ always_comb begin
         internal_data.reg_data[2] = csr_data;
     end
 
+    // Unconditional jumps redirect fetch from decode unless the predictor
+    // already fetched the target, exec sees a right prediction and only
+    // trains the predictor. JALR needs rs1 from the register file
+    do_jump = 0;
+    jump_addr = fetch_decode_buff.pc + immediate;
+    if (internal_instr.opcode == OPCODE_JALR) jump_addr = reg_data[0] + immediate;
+
+    if (!stall && !stop &&
+        ((EARLY_JUMP_MODE >= EARLY_JUMP_JAL && internal_instr.opcode == OPCODE_JAL) ||
+         (EARLY_JUMP_MODE >= EARLY_JUMP_JALR && internal_instr.opcode == OPCODE_JALR &&
+          bypass_rs[0] == NO_BYPASS))) begin
+        do_jump = !internal_data.prediction.taken ||
+            internal_data.prediction.target != jump_addr;
+        internal_data.prediction.taken = 1;
+        internal_data.prediction.target = jump_addr;
+    end
+
     output_internal_data = internal_data;
 
     if (stall | set_nop) begin
+        output_internal_data.valid = 0;
         output_internal_data.instr = RV_NOP;
         output_internal_data.control = create_nop_ctrl();
+        output_internal_data.prediction = create_not_taken_prediction();
         if (set_nop) output_internal_data.pc = set_nop_pc;
     end
 
@@ -92,9 +137,11 @@ end
 
 always_ff @(posedge clk) begin
     if (!resetn) begin
+        decode_exec_buff.valid <= 0;
         decode_exec_buff.instr <= RV_NOP;
         decode_exec_buff.control <= create_nop_ctrl();
         decode_exec_buff.pc <= 0;
+        decode_exec_buff.prediction <= create_not_taken_prediction();
     end
     else if (!stop) begin
         decode_exec_buff <= output_internal_data;
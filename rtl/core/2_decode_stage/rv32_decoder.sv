@@ -3,6 +3,7 @@
 /* 
  RISCV Instruction decoder
  - RV32I
+ - M extension
  - C compression detection (not decoding yet)
  - Zicsr extension
 */
@@ -116,8 +117,9 @@ always_comb begin
             use_rs[1] = 1;
 
             case (instr.funct7)
-                7'b0000001: begin // Mul extension
-                    control.wb_result_src = WB_MUL_UNIT;
+                7'b0000001: begin // M extension
+                    if (instr.funct3[2]) control.wb_result_src = WB_DIV_UNIT;
+                    else control.wb_result_src = WB_MUL_UNIT;
                 end
                 default: begin // Base integer instructions
                     control.int_alu_instr.op = int_alu_op_t'({instr.funct7[5], instr.funct3});
@@ -158,7 +160,9 @@ always_comb begin
         // RD = CSR
         OPCODE_ZICSR: begin
             control.register_wb = 1;
-            control.csr_wb = 1;
+            // csrrs/csrrc with rs1 = x0 (or zero immediate) only read, a
+            // read of a counter does not write back a stale value
+            control.csr_wb = instr.funct3[1:0] == CSR_RW || instr.rs1 != 0;
             control.wb_result_src = WB_CSR;
             use_rs[0] = 1;
         end
@@ -185,6 +189,9 @@ always_comb begin
             endcase
         end
 
+        // fence, nop that waits in memory for the store buffer to drain
+        OPCODE_BARRIER: ;
+
         default: begin
             // Invalid instruction detection
             control.invalid = 1;
@@ -11,12 +11,17 @@ import rv32_types::*;
     input decode_exec_buffer_t decode_exec_buff,
     input exec_mem_buffer_t exec_mem_buff,
     output logic stall,
-    output bypass_t [2:0] bypass_rs
+    // Stall cause, load use or pipelined MUL use
+    output logic load_use_stall,
+    output logic mul_use_stall,
+    output bypass_t [2:0] bypass_rs,
+    output bypass_t bypass_csr
 );
 
 always_comb begin
     // Data Hazzard detection
     logic stall_vec[3] = '{default: 0};
+    logic mul_stall_vec[3] = '{default: 0};
 
     for(int idx = 0; idx < 3; idx = idx + 1) begin
         rv_reg_id_t rs;
@@ -39,23 +44,37 @@ always_comb begin
             // Load use generates one nop bubble always
             if (decode_exec_buff.control.wb_result_src == WB_MEM_DATA)
                 stall_vec[idx] = 1;
+            // Pipelined MUL result is ready at writeback too
+            if (MUL_STAGES > 1 && decode_exec_buff.control.wb_result_src == WB_MUL_UNIT)
+                mul_stall_vec[idx] = 1;
         end
 
         // No dependency
         if (!use_rs[idx]) begin
             bypass_rs[idx] = NO_BYPASS;
             stall_vec[idx] = 0;
+            mul_stall_vec[idx] = 0;
         end
     end
 
-    stall = stall_vec.or();
+    load_use_stall = stall_vec.or();
+    mul_use_stall = mul_stall_vec.or();
 
     // CSR Hazzard detection
-    // Only 1 CSR instruction ins allowed in the pipeline
+    // CSRs are read at decode and written at mem, a write to the same CSR
+    // at exec or mem is bypassed with its new value, never stalls
+    bypass_csr = NO_BYPASS;
     if (current_control.wb_result_src == WB_CSR) begin
-        stall = stall | (decode_exec_buff.control.wb_result_src == WB_CSR);
-        stall = stall | (exec_mem_buff.control.wb_result_src == WB_CSR);
+        if (current_instr[31:20] == exec_mem_buff.instr[31:20] &&
+            exec_mem_buff.control.csr_wb)
+            bypass_csr = BYPASS_MEM_BUFF;
+
+        if (current_instr[31:20] == decode_exec_buff.instr[31:20] &&
+            decode_exec_buff.control.csr_wb)
+            bypass_csr = BYPASS_EXEC_BUFF;
     end
+
+    stall = load_use_stall | mul_use_stall;
 end
 
 endmodule
@@ -1,12 +1,12 @@
 module adder_tree_12_12 (
     input logic clk, enable,
     input logic[11:0][11:0] data,
-    output logic[15:0] result
+    output logic[15:0] result /*verilator public*/
 );
 
-logic [5:0][12:0] buff_l0l1, out_l0;
-logic [2:0][13:0] buff_l1l2, out_l1;
-logic [1:0][14:0] buff_l2l3, out_l2;
+logic [5:0][12:0] buff_l0l1 /*verilator public*/, out_l0;
+logic [2:0][13:0] buff_l1l2 /*verilator public*/, out_l1;
+logic [1:0][14:0] buff_l2l3 /*verilator public*/, out_l2;
 logic [15:0] out_l3;
 
 always_ff @(posedge clk) begin
@@ -12,7 +12,7 @@ import rv32_types::*;
 const logic [150:0] RESET_SEED = 151'b0111001100100100110011101101000111101000001000100001000111001100011000101110010111111111011101101110110110110000100001000010010110001101000011111001000;
 
 // Control logic
-logic [2:0] current_state, next_state;
+logic [2:0] current_state /*verilator public*/, next_state;
 logic uc_enable, uc_set, state_change;
 logic [150:0] uc_seed;
 
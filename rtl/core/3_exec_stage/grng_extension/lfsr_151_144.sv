@@ -1,7 +1,7 @@
 module lfsr_151_144 (
     input logic clk, enable, set,
     input logic[150:0] seed,
-    output logic[150:0] current_state
+    output logic[150:0] current_state /*verilator public*/
 );
 
 always_ff @(posedge clk) begin
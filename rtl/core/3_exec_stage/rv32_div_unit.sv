@@ -0,0 +1,137 @@
+/* verilator lint_off UNUSEDSIGNAL */
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off WIDTHEXPAND */
+
+// 32 bit integer division unit
+// Restoring divider on the operand magnitudes, RADIX 2 or 4 quotient bits
+// per cycle. Only the significant bits of the dividend are iterated, a
+// dividend below the divisor and division by zero take no extra cycle
+// The operands are taken the first cycle the instruction is in exec, the
+// result is held until the instruction leaves it
+
+module rv32_div_unit
+import rv32_types::*;
+#(
+    parameter int RADIX = DIV_RADIX
+) (
+    input logic clk, resetn,
+    input logic start,
+    // The instruction leaves exec
+    input logic advance,
+    input rv32_word op1, op2,
+    // funct3[1:0] DIV, DIVU, REM, REMU
+    input logic [1:0] opsel,
+    output logic stall,
+    output rv32_word result
+);
+
+localparam int STEPS = RADIX == 4 ? 2 : 1;
+
+typedef enum logic [1:0] {
+    DIV_IDLE,
+    DIV_BUSY,
+    DIV_DONE
+} div_state_t;
+div_state_t state;
+
+// Iteration state
+logic [32:0] remainder;
+rv32_word quotient, divisor;
+logic [5:0] bits_left;
+logic negate_quotient, negate_remainder, want_remainder;
+rv32_word done_result;
+
+// Operand setup
+logic is_signed;
+rv32_word abs_dividend, abs_divisor;
+logic sign_dividend, sign_divisor;
+logic [5:0] dividend_bits;
+logic early;
+rv32_word early_result;
+always_comb begin
+    is_signed = !opsel[0];
+    sign_dividend = is_signed && op1[31];
+    sign_divisor = is_signed && op2[31];
+    abs_dividend = sign_dividend ? -op1 : op1;
+    abs_divisor = sign_divisor ? -op2 : op2;
+
+    dividend_bits = 0;
+    for (int b = 0; b < 32; b = b + 1) begin
+        if (abs_dividend[b]) dividend_bits = b + 1;
+    end
+
+    // Division by zero, quotient all ones and remainder the dividend
+    // Dividend below the divisor, quotient 0 and remainder the dividend
+    early = op2 == 0 || abs_dividend < abs_divisor;
+    if (opsel[1]) early_result = op1;
+    else if (op2 == 0) early_result = 32'hffffffff;
+    else early_result = 0;
+end
+
+// Shift and subtract steps of one cycle
+logic [32:0] next_remainder;
+rv32_word next_quotient;
+always_comb begin
+    next_remainder = remainder;
+    next_quotient = quotient;
+    for (int s = 0; s < STEPS; s = s + 1) begin
+        if (s < int'(bits_left)) begin
+            next_remainder = {next_remainder[31:0], next_quotient[31]};
+            next_quotient = {next_quotient[30:0], 1'b0};
+            if (next_remainder >= {1'b0, divisor}) begin
+                next_remainder = next_remainder - {1'b0, divisor};
+                next_quotient[0] = 1;
+            end
+        end
+    end
+end
+
+always_comb begin
+    stall = 0;
+    result = done_result;
+    if (state == DIV_IDLE) begin
+        result = early_result;
+        stall = start && !early;
+    end
+    else if (state == DIV_BUSY) stall = 1;
+end
+
+always_ff @(posedge clk) begin
+    if (!resetn) state <= DIV_IDLE;
+
+    else case (state)
+        DIV_IDLE: begin
+            if (start && !early) begin
+                state <= DIV_BUSY;
+                remainder <= 0;
+                // Dividend msb first, leading zeros skipped
+                quotient <= abs_dividend << (32 - dividend_bits);
+                divisor <= abs_divisor;
+                bits_left <= dividend_bits;
+                negate_quotient <= sign_dividend != sign_divisor;
+                negate_remainder <= sign_dividend;
+                want_remainder <= opsel[1];
+            end
+        end
+
+        DIV_BUSY: begin
+            remainder <= next_remainder;
+            quotient <= next_quotient;
+            if (int'(bits_left) <= STEPS) begin
+                state <= DIV_DONE;
+                bits_left <= 0;
+                if (want_remainder)
+                    done_result <= negate_remainder ? -next_remainder[31:0] : next_remainder[31:0];
+                else
+                    done_result <= negate_quotient ? -next_quotient : next_quotient;
+            end
+            else bits_left <= bits_left - STEPS;
+        end
+
+        DIV_DONE: if (advance) state <= DIV_IDLE;
+
+        default: state <= DIV_IDLE;
+    endcase
+end
+
+endmodule
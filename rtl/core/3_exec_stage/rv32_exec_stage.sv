@@ -6,7 +6,8 @@
  - Immediate generation
  - Integer ALU
  - Integer MUL
- - Branch
+ - Integer DIV, multi-cycle
+ - Branch resolution
 */
 
 module rv32_exec_stage
@@ -18,11 +19,19 @@ import rv32_types::*;
     input decode_exec_buffer_t decode_exec_buff,
     output exec_mem_buffer_t exec_mem_buff,
     input logic stop,
+    // Multi-cycle instruction in progress, exec sends bubbles to mem
+    output logic stall,
     // Jump control signals
+    // Fetch is redirected when the prediction made at fetch was wrong
     output logic do_jump,
     output rv32_word jump_addr,
+    output branch_resolution_t branch_resolution,
     // Bypass data
-    input rv32_word wb_bypass
+    input rv32_word wb_bypass,
+    // CSR value written by the instruction at writeback
+    input rv32_word wb_csr_bypass,
+    // Pipelined MUL, result of the instruction at writeback
+    output rv32_word mul_wb_result
 );
 
 exec_mem_buffer_t internal_data /*verilator public*/;
@@ -50,9 +59,19 @@ rv32_immediate_gen immediate_gen(
 
 // Zicsr functional unit
 zicsr_op_t zicsr_unit_op;
-rv32_word zicsr_operand_data, zicsr_reg_result, zicsr_csr_result;
+rv32_word zicsr_csr_data, zicsr_operand_data, zicsr_reg_result, zicsr_csr_result;
 // Operand selection
 always_comb begin
+    // CSR bypass, new value of a CSR written by an older instruction as the
+    // CSR file keeps it
+    case (decode_exec_buff.control.bypass_csr)
+        BYPASS_EXEC_BUFF: zicsr_csr_data = csr_legalize(
+            decode_exec_buff.instr[31:20], exec_mem_buff.data_result[1]);
+        BYPASS_MEM_BUFF: zicsr_csr_data = csr_legalize(
+            decode_exec_buff.instr[31:20], wb_csr_bypass);
+        default: zicsr_csr_data = decode_exec_buff.reg_data[2];
+    endcase
+
     zicsr_unit_op = zicsr_op_t'(decode_exec_buff.instr.funct3[1:0]);
     // Register
     if (decode_exec_buff.instr.funct3[2] == 0) zicsr_operand_data = reg_data[0];
@@ -63,7 +82,7 @@ always_comb begin
     end
 end
 rv32_zicsr_unit zicsr_unit (
-    .csr(reg_data[2]), .operand(zicsr_operand_data),
+    .csr(zicsr_csr_data), .operand(zicsr_operand_data),
     .opsel(zicsr_unit_op),
     .reg_result(zicsr_reg_result), .csr_result(zicsr_csr_result)
 );
@@ -89,13 +108,40 @@ rv32_int_alu int_alu (
 );
 
 // Branch unit
+logic branch_taken, div_stall;
 rv32_branch_unit branch_unit (
     .op1(reg_data[0]), .op2(reg_data[1]),
     .branch_op(decode_exec_buff.control.branch_op),
-    .do_branch(do_jump)
+    .do_branch(branch_taken)
 );
 always_comb begin
-    jump_addr = int_alu_result;
+    branch_prediction_t prediction;
+    rv_instr_t instr;
+    prediction = decode_exec_buff.prediction;
+    instr = decode_exec_buff.instr;
+
+    // A stalled instruction redirects when it leaves exec
+    do_jump = !div_stall && ((branch_taken != prediction.taken) ||
+        (branch_taken && prediction.target != int_alu_result));
+    if (branch_taken) jump_addr = int_alu_result;
+    else jump_addr = decode_exec_buff.pc + 4;
+
+    // Train the predictor once, when the instruction leaves exec
+    branch_resolution.control_flow = decode_exec_buff.control.branch_op != OP_NOP;
+    branch_resolution.valid = !stop && !div_stall && (branch_resolution.control_flow || do_jump);
+    branch_resolution.conditional = decode_exec_buff.control.branch_op != OP_J;
+    branch_resolution.taken = branch_taken;
+    branch_resolution.mispredict = do_jump;
+    branch_resolution.pc = decode_exec_buff.pc;
+    branch_resolution.target = int_alu_result;
+    branch_resolution.bht_index = prediction.bht_index;
+
+    // x1 and x5 are link registers
+    if (decode_exec_buff.control.branch_op != OP_J) branch_resolution.kind = BTB_BRANCH;
+    else if (instr.rd == 1 || instr.rd == 5) branch_resolution.kind = BTB_CALL;
+    else if (instr.opcode == OPCODE_JALR && (instr.rs1 == 1 || instr.rs1 == 5))
+        branch_resolution.kind = BTB_RET;
+    else branch_resolution.kind = BTB_JUMP;
 end
 
 // Mul unit
@@ -109,6 +155,30 @@ rv32_mul_unit mul_unit (
     .opsel(mul_unit_op),
     .result(mul_unit_result)
 );
+rv32_pipelined_mul_unit pipelined_mul_unit (
+    .clk(clk), .resetn(resetn),
+    .advance(!stop),
+    .op1(reg_data[0]), .op2(reg_data[1]),
+    .opsel(mul_unit_op),
+    .result(mul_wb_result)
+);
+
+// Div unit
+logic div_start;
+rv32_word div_unit_result;
+always_comb begin
+    div_start = decode_exec_buff.control.wb_result_src == WB_DIV_UNIT;
+    stall = div_stall;
+end
+rv32_div_unit div_unit (
+    .clk(clk), .resetn(resetn),
+    .start(div_start),
+    .advance(!stop),
+    .op1(reg_data[0]), .op2(reg_data[1]),
+    .opsel(decode_exec_buff.instr.funct3[1:0]),
+    .stall(div_stall),
+    .result(div_unit_result)
+);
 
 // GRNG unit
 rv32_word grng_result;
@@ -121,6 +191,7 @@ clt_grng_16 grng (
 
 
 always_comb begin
+    internal_data.valid = decode_exec_buff.valid;
     internal_data.instr = decode_exec_buff.instr;
     internal_data.pc = decode_exec_buff.pc;
     internal_data.control = decode_exec_buff.control;
@@ -131,7 +202,12 @@ always_comb begin
         WB_PC4: internal_data.data_result[0] = decode_exec_buff.pc + 4;
         WB_INT_ALU: internal_data.data_result[0] = int_alu_result;
         WB_STORE: internal_data.data_result[0] = reg_data[1];
-        WB_MUL_UNIT: internal_data.data_result[0] = mul_unit_result;
+        WB_MUL_UNIT: begin
+            // Pipelined result is selected at writeback
+            if (MUL_STAGES == 1) internal_data.data_result[0] = mul_unit_result;
+            else internal_data.data_result[0] = 0;
+        end
+        WB_DIV_UNIT: internal_data.data_result[0] = div_unit_result;
         WB_GRNG: internal_data.data_result[0] = grng_result;
         WB_CSR: begin 
             internal_data.data_result[0] = zicsr_reg_result;
@@ -143,11 +219,20 @@ end
 
 always_ff @(posedge clk) begin
     if (!resetn) begin
+        exec_mem_buff.valid <= 0;
         exec_mem_buff.instr <= RV_NOP;
         exec_mem_buff.pc <= 0;
         exec_mem_buff.control <= create_nop_ctrl();
     end
-    else if (!stop) exec_mem_buff <= internal_data;
+    else if (!stop) begin
+        if (stall) begin
+            exec_mem_buff.valid <= 0;
+            exec_mem_buff.instr <= RV_NOP;
+            exec_mem_buff.pc <= decode_exec_buff.pc;
+            exec_mem_buff.control <= create_nop_ctrl();
+        end
+        else exec_mem_buff <= internal_data;
+    end
 end
 
 endmodule;
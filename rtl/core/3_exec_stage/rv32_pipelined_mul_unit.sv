@@ -0,0 +1,72 @@
+/* verilator lint_off UNUSEDSIGNAL */
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off WIDTHEXPAND */
+
+// 32 bit integer multiplication unit, pipelined
+// One 33x33 signed multiplier for the 4 ops, the operands are sign or zero
+// extended to 33 bits
+// - exec: operand extension, registered
+// - mem: 33x33 product (STAGES 2) or its two 33x17 halves (STAGES 3),
+//   registered
+// - writeback: halves sum (STAGES 3) and result selection
+// The registers move with the exec/mem and mem/writeback buffers, the
+// result belongs to the instruction at writeback
+
+module rv32_pipelined_mul_unit
+import rv32_types::*;
+#(
+    parameter int STAGES = MUL_STAGES
+) (
+    input logic clk, resetn,
+    // Pipeline buffers update
+    input logic advance,
+    // Exec
+    input rv32_word op1, op2,
+    input mul_op_t opsel,
+    // Writeback
+    output rv32_word result
+);
+
+// Exec/mem
+logic signed [32:0] a, b;
+mul_op_t mem_opsel;
+
+// Mem/writeback
+logic signed [65:0] product;
+logic signed [50:0] partial_lo;
+logic signed [48:0] partial_hi;
+mul_op_t wb_opsel;
+
+logic signed [32:0] ext_op1, ext_op2;
+always_comb begin
+    ext_op1 = {opsel != MUL_OP_MULHU && op1[31], op1};
+    ext_op2 = {(opsel == MUL_OP_MUL || opsel == MUL_OP_MULH) && op2[31], op2};
+end
+
+always_ff @(posedge clk) begin
+    if (advance) begin
+        a <= ext_op1;
+        b <= ext_op2;
+        mem_opsel <= opsel;
+
+        wb_opsel <= mem_opsel;
+        if (STAGES == 3) begin
+            partial_lo <= a * $signed({1'b0, b[16:0]});
+            partial_hi <= a * $signed(b[32:17]);
+        end
+        else product <= a * b;
+    end
+end
+
+logic signed [65:0] full_product;
+always_comb begin
+    if (STAGES == 3) full_product = 66'(partial_lo) + (66'(partial_hi) <<< 17);
+    else full_product = product;
+
+    case (wb_opsel)
+        MUL_OP_MUL: result = full_product[31:0];
+        default: result = full_product[63:32];
+    endcase
+end
+
+endmodule
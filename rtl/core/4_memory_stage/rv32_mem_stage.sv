@@ -3,6 +3,7 @@
 /*
  CPU 4 memory stage
  - Memory requests
+ - Store buffer
 */
 
 
@@ -18,6 +19,9 @@ import rv32_types::*;
     // Data Mem I/O
     output memory_request_t data_request,
     input logic request_done,
+    input rv32_word data,
+    // Writeback load data
+    output rv32_word load_data,
     // CSR file O
     output csr_write_request_t csr_write_request
 );
@@ -31,22 +35,39 @@ always_comb begin
     csr_write_request.write = exec_mem_buff.control.csr_wb;
 end
 
-// Send data request to memory bus
+// Memory access of the instruction, sent through the store buffer
+memory_request_t stage_request /*verilator public*/;
+logic fence, stage_done;
 always_comb begin
-    data_request.addr = exec_mem_buff.data_result[1];
-    data_request.op = exec_mem_buff.control.mem_op;
-    data_request.data = exec_mem_buff.data_result[0];
+    stage_request.addr = exec_mem_buff.data_result[1];
+    stage_request.op = exec_mem_buff.control.mem_op;
+    stage_request.data = exec_mem_buff.data_result[0];
+    fence = exec_mem_buff.instr.opcode == OPCODE_BARRIER;
 end
 
+rv32_store_buffer store_buffer (
+    .clk(clk), .resetn(resetn),
+    // Memory stage
+    .stage_request(stage_request),
+    .fence(fence),
+    .stage_done(stage_done),
+    .stage_data(load_data),
+    // Data port
+    .port_request(data_request),
+    .port_done(request_done),
+    .port_data(data)
+);
+
 always_comb begin
     // Forward signals
     internal_data = exec_mem_buff;
-    if (exec_mem_buff.control.mem_op == MEM_NOP) stall = 0;
-    else stall = ~request_done;
+    if (exec_mem_buff.control.mem_op == MEM_NOP && !fence) stall = 0;
+    else stall = ~stage_done;
 end
 
 always_ff @(posedge clk) begin
     if(!resetn) begin
+        mem_wb_buff.valid <= 0;
         mem_wb_buff.instr <= RV_NOP;
         mem_wb_buff.control <= create_nop_ctrl();
         mem_wb_buff.pc <= 0;
@@ -0,0 +1,182 @@
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off UNUSEDSIGNAL */
+/* verilator lint_off WIDTHEXPAND */
+
+/*
+ Store buffer
+ - Stores complete as soon as there is a free entry and are written in
+   order when the data port is not used by a load
+ - Loads read the bytes of pending stores to the same word, a load that
+   only finds part of its bytes waits for the stores to drain
+ - Loads of other words go to the port before the pending stores, MMIO
+   loads wait for the buffer to drain
+ - fence completes once the buffer is empty, stores to MMIO followed by
+   loads of memory need it to be seen in order
+ With 0 entries the memory stage is connected to the port directly
+*/
+
+module rv32_store_buffer
+import rv32_types::*;
+#(
+    parameter int ENTRIES = STORE_BUFFER
+) (
+    input logic clk, resetn,
+    // Memory stage
+    input memory_request_t stage_request,
+    input logic fence,
+    output logic stage_done,
+    output rv32_word stage_data,
+    // Data port
+    output memory_request_t port_request,
+    input logic port_done,
+    input rv32_word port_data
+);
+
+localparam rv32_word UNCACHED_BASE = 32'h10000000;
+
+localparam int DEPTH = ENTRIES > 0 ? ENTRIES : 1;
+localparam int COUNT_BITS = $clog2(DEPTH + 1);
+localparam int PTR_BITS = DEPTH > 1 ? $clog2(DEPTH) : 1;
+
+memory_request_t entries [DEPTH];
+logic [PTR_BITS-1:0] head, tail;
+logic [COUNT_BITS-1:0] count;
+
+// The head store is on the port and was not accepted yet, the port keeps
+// it until it is
+logic draining;
+
+// Load data of the last served load, port loads are kept from the next
+// cycle as writeback reads it again while the memory stage stalls
+logic port_served;
+rv32_word load_data;
+
+// Bytes of the word accessed
+function automatic logic [3:0] byte_mask(input mem_op_t op, input logic [1:0] offset);
+    case (op)
+        MEM_LB, MEM_LBU, MEM_SB: return 4'b0001 << offset;
+        MEM_LH, MEM_LHU, MEM_SH: begin
+            if (offset == 2'b00) return 4'b0011;
+            else if (offset == 2'b10) return 4'b1100;
+            else return 4'b1111;
+        end
+        default: return 4'b1111;
+    endcase
+endfunction
+
+// Store data placed in its byte lanes, as main memory writes it
+function automatic rv32_word store_lanes(input rv32_word data, input mem_op_t op);
+    case (op)
+        MEM_SB: return {4{data[7:0]}};
+        MEM_SH: return {2{data[15:0]}};
+        default: return data;
+    endcase
+endfunction
+
+// Misaligned halfword/word stores are never forwarded
+function automatic logic misaligned(input mem_op_t op, input logic [1:0] offset);
+    return (op == MEM_SH && offset[0]) || (op == MEM_SW && offset != 0);
+endfunction
+
+logic load, store, uncached;
+logic [3:0] load_mask, covered, entry_mask;
+logic blocked, forward, wait_drain, load_port;
+rv32_word forward_data, entry_data;
+memory_request_t entry;
+always_comb begin
+    load = stage_request.op != MEM_NOP && !stage_request.op[3];
+    store = stage_request.op != MEM_NOP && stage_request.op[3];
+    uncached = stage_request.addr >= UNCACHED_BASE;
+    load_mask = byte_mask(stage_request.op, stage_request.addr[1:0]);
+
+    // Youngest pending byte of each lane of the loaded word
+    covered = 0;
+    blocked = 0;
+    forward_data = 0;
+    for (int i = 0; i < DEPTH; i = i + 1) begin
+        entry = entries[(int'(head) + i) % DEPTH];
+        entry_mask = byte_mask(entry.op, entry.addr[1:0]);
+        entry_data = store_lanes(entry.data, entry.op);
+        if (i < int'(count) && entry.addr[31:2] == stage_request.addr[31:2]) begin
+            if (misaligned(entry.op, entry.addr[1:0])) blocked = 1;
+            for (int b = 0; b < 4; b = b + 1) begin
+                if (entry_mask[b]) begin
+                    covered[b] = 1;
+                    forward_data[b * 8 +: 8] = entry_data[b * 8 +: 8];
+                end
+            end
+        end
+    end
+
+    if (uncached) begin
+        forward = 0;
+        wait_drain = count != 0;
+    end
+    else begin
+        forward = !blocked && (covered & load_mask) == load_mask;
+        wait_drain = (covered & load_mask) != 0 && !forward;
+    end
+
+    load_port = load && !forward && !wait_drain && !draining;
+end
+
+always_comb begin
+    if (ENTRIES == 0) begin
+        port_request = stage_request;
+        stage_done = port_done || fence;
+        stage_data = port_data;
+    end
+    else begin
+        if (port_served) stage_data = port_data;
+        else stage_data = load_data;
+
+        port_request = stage_request;
+        if (!load_port) begin
+            port_request = entries[head];
+            if (count == 0) port_request.op = MEM_NOP;
+        end
+
+        if (store) stage_done = int'(count) != ENTRIES;
+        else if (load) stage_done = forward || (load_port && port_done);
+        else if (fence) stage_done = count == 0;
+        else stage_done = 1;
+    end
+end
+
+logic push, pop;
+always_comb begin
+    push = store && stage_done;
+    pop = !load_port && count != 0 && port_done;
+end
+
+always_ff @(posedge clk) begin
+    if (!resetn) begin
+        head <= 0;
+        tail <= 0;
+        count <= 0;
+        draining <= 0;
+        port_served <= 0;
+    end
+
+    else if (ENTRIES != 0) begin
+        draining <= !load_port && count != 0 && !port_done;
+
+        if (push) begin
+            entries[tail] <= stage_request;
+            tail <= tail == DEPTH - 1 ? 0 : tail + 1'b1;
+        end
+        if (pop) head <= head == DEPTH - 1 ? 0 : head + 1'b1;
+        count <= count + push - pop;
+
+        if (port_served) begin
+            load_data <= port_data;
+            port_served <= 0;
+        end
+        if (load && stage_done) begin
+            if (forward) load_data <= forward_data;
+            else port_served <= 1;
+        end
+    end
+end
+
+endmodule
@@ -13,6 +13,8 @@ import rv32_types::*;
     input mem_wb_buffer_t mem_wb_buff,
     // Mem data input
     input rv32_word mem_data,
+    // Pipelined MUL result
+    input rv32_word mul_result,
     // Register File I/O
     output register_write_request_t rf_write_request
 );
@@ -35,6 +37,10 @@ always_comb begin
     // Set mem load result if required
     case (mem_wb_buff.control.wb_result_src)
         WB_MEM_DATA: rf_write_request.data = fixed_load;
+        WB_MUL_UNIT: begin
+            if (MUL_STAGES == 1) rf_write_request.data = mem_wb_buff.data_result[0];
+            else rf_write_request.data = mul_result;
+        end
         default: rf_write_request.data = mem_wb_buff.data_result[0];
     endcase
 end
@@ -31,25 +31,42 @@ rv32_word wb_bypass;
 
 // PC/Jump logic
 logic exec_jump /*verilator public*/;
-logic jump_set_nop;
-rv32_word exec_jump_addr, jump_nop_pc;
+logic decode_jump /*verilator public*/;
+logic jump_set_nop, fetch_set_nop;
+rv32_word exec_jump_addr, decode_jump_addr, jump_nop_pc;
 rv32_word pc, next_pc /*verilator public*/;
+branch_prediction_t prediction;
+branch_resolution_t branch_resolution;
 
 always_comb begin
     jump_set_nop = 0;
+    fetch_set_nop = 0;
     jump_nop_pc = decode_exec_buff.pc;
 
-    // Default pc increase
-    next_pc = pc + 4;
+    // Default pc increase or predicted branch target
+    if (prediction.taken) next_pc = prediction.target;
+    else next_pc = pc + 4;
 
-    // Jump instruction
+    // Exec redirect, the predicted next pc was wrong
     if(exec_jump) begin
         next_pc = exec_jump_addr;
         jump_set_nop = 1;
+        fetch_set_nop = 1;
     end
 
-    // A instruction is stalling
-    else if (dec_stall | mem_stall) next_pc = pc;
+    // A instruction is stalling, with instruction queue fetch goes on
+    else if (FETCH_QUEUE == 0 && (dec_stall | exec_stall | mem_stall)) next_pc = pc;
+
+    // Decode redirect, only the instruction being fetched is flushed
+    else if (decode_jump) begin
+        next_pc = decode_jump_addr;
+        fetch_set_nop = 1;
+        jump_nop_pc = fetch_decode_buff.pc;
+    end
+
+    // Instruction memory has not served the request yet or the
+    // instruction queue is full
+    else if (fetch_stall) next_pc = pc;
 end
 
 always_ff @(posedge clk) begin
@@ -61,9 +78,9 @@ end
 rv_reg_id_t [2:0] rs;
 rv32_word [2:0] reg_data;
 always_comb begin
-    rs[0] = instr.rs1;
-    rs[1] = instr.rs2;
-    rs[2] = instr.rd;
+    rs[0] = decode_instr.rs1;
+    rs[1] = decode_instr.rs2;
+    rs[2] = decode_instr.rd;
 end
 
 register_write_request_t rf_write_request /*verilator public*/;
@@ -78,46 +95,98 @@ rv32_register_file rf(
 // CSR
 rv32_word csr_read_data;
 rv_csr_id_t csr_read_id;
-csr_write_request_t csr_write_request;
+csr_write_request_t csr_write_request /*verilator public*/;
 always_comb begin 
-    csr_read_id = instr[31:20];
+    csr_read_id = decode_instr[31:20];
+end
+
+// An instruction retires when it leaves the memory stage, the instructions
+// there are never flushed
+logic instr_retired;
+logic [HPM_EVENTS-1:0] hpm_events;
+always_comb begin
+    instr_retired = !mem_stall && exec_mem_buff.valid;
+
+    hpm_events = 0;
+    hpm_events[HPM_EVENT_LOAD_USE] = load_use_stall && !exec_stall && !mem_stall;
+    hpm_events[HPM_EVENT_MEM_STALL] = mem_stall;
+    // A jump held in exec by a memory stall is counted once
+    hpm_events[HPM_EVENT_BRANCH_FLUSH] = exec_jump && !mem_stall;
+    hpm_events[HPM_EVENT_BRANCH_TAKEN] = branch_resolution.valid &&
+        branch_resolution.control_flow && branch_resolution.taken;
+    hpm_events[HPM_EVENT_LOAD_STORE] = instr_retired &&
+        exec_mem_buff.control.mem_op != MEM_NOP;
+    hpm_events[HPM_EVENT_MUL_GRNG] = instr_retired &&
+        (exec_mem_buff.control.wb_result_src == WB_MUL_UNIT ||
+         exec_mem_buff.instr.opcode == OPCODE_GRNG);
 end
+
 rv32_csr csr_file(
     .clk(clk), .resetn(resetn),
     .read_id(csr_read_id), .read_value(csr_read_data),
     .write_request(csr_write_request),
-    .instr_retired(0)
+    .instr_retired(instr_retired),
+    .hpm_events(hpm_events)
+);
+
+// Branch predictor
+logic fetch_advance;
+always_comb begin
+    fetch_advance = fetch_request_advance && !fetch_set_nop;
+end
+rv32_branch_predictor branch_predictor(
+    .clk(clk), .resetn(resetn),
+    // Fetch lookup
+    .pc(pc),
+    .fetch_advance(fetch_advance),
+    .prediction(prediction),
+    // Exec resolution
+    .resolution(branch_resolution)
 );
 
 // FETCH STAGE
 logic fetch_stall /*verilator public*/;
+// Decode gets no instruction the next cycle
+logic fetch_bubble /*verilator public*/;
+logic fetch_request_advance;
+rv_instr_t decode_instr;
 rv32_fetch_stage fetch_stage(
     .clk(clk), .resetn(resetn),
     // Pipeline I/O
     .pc(pc),
+    .prediction(prediction),
     .fetch_decode_buff(fetch_decode_buff),
+    .decode_instr(decode_instr),
     // Control
     .stall(fetch_stall),
-    .stop(dec_stall | mem_stall),
+    .advance(fetch_request_advance),
+    .bubble(fetch_bubble),
+    .stop(dec_stall | exec_stall | mem_stall),
     // Jump signals
-    .set_nop(jump_set_nop),
+    .set_nop(fetch_set_nop),
     .set_nop_pc(jump_nop_pc),
     // INSTR MEM I/O
     .instr_request(instr_request),
-    .request_done(instr_request_done)
+    .request_done(instr_request_done),
+    .instr(instr)
 );
 
 // DECODE STAGE
 logic dec_stall /*verilator public*/;
+logic load_use_stall /*verilator public*/;
 rv32_decode_stage decode_stage(
     .clk(clk), .resetn(resetn),
     // Pipeline I/O
     .fetch_decode_buff(fetch_decode_buff),
-    .instr(instr),
+    .instr(decode_instr),
     .decode_exec_buff(decode_exec_buff),
     // Control
     .stall(dec_stall),
-    .stop(mem_stall),
+    .load_use_stall(load_use_stall),
+    .stop(exec_stall | mem_stall),
+    // Early jump
+    .do_jump(decode_jump),
+    .jump_addr(decode_jump_addr),
     // Jump signals
     .set_nop(jump_set_nop),
     .set_nop_pc(jump_nop_pc),
@@ -130,6 +199,8 @@ rv32_decode_stage decode_stage(
 );
 
 // EXECUTION STAGE
+logic exec_stall /*verilator public*/;
+rv32_word mul_wb_result;
 rv32_exec_stage exec_stage(
     .clk(clk), .resetn(resetn),
     // Pipeline I/O
@@ -137,15 +208,20 @@ rv32_exec_stage exec_stage(
     .exec_mem_buff(exec_mem_buff),
     // Control
     .stop(mem_stall),
+    .stall(exec_stall),
     // Jump signals
     .do_jump(exec_jump),
     .jump_addr(exec_jump_addr),
+    .branch_resolution(branch_resolution),
     // Bypass
-    .wb_bypass(rf_write_request.data)
+    .wb_bypass(rf_write_request.data),
+    .wb_csr_bypass(mem_wb_buff.data_result[1]),
+    .mul_wb_result(mul_wb_result)
 );
 
 // MEMORY STAGE
 logic mem_stall /*verilator public*/;
+rv32_word load_data;
 rv32_mem_stage mem_stage(
     .clk(clk), .resetn(resetn),
     // Pipeline I/O
@@ -156,6 +232,8 @@ rv32_mem_stage mem_stage(
     // Data Memory I/O
     .data_request(data_request),
     .request_done(data_request_done),
+    .data(data),
+    .load_data(load_data),
     // CSR File O
     .csr_write_request(csr_write_request)
 );
@@ -164,7 +242,8 @@ rv32_mem_stage mem_stage(
 rv32_wb_stage wb_stage(
     .mem_wb_buff(mem_wb_buff),
     // Memory I
-    .mem_data(data),
+    .mem_data(load_data),
+    .mul_result(mul_wb_result),
     // Register File O
     .rf_write_request(rf_write_request)
 );
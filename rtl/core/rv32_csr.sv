@@ -1,9 +1,13 @@
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off WIDTHEXPAND */
 
 // Control and status registers bank
 
 module rv32_csr
 import rv32_types::*;
-(
+#(
+    parameter int NUM_HPM_COUNTERS = HPM_COUNTERS
+) (
     input logic clk, resetn,
     // Read ports
     input rv_csr_id_t read_id,
@@ -13,44 +17,40 @@ import rv32_types::*;
     // Always available signals, mstatus...
     // TODO
     // Performance counters...
-    input logic instr_retired
+    input logic instr_retired,
+    // Events of this cycle, indexed by hpm_event_t
+    input logic [HPM_EVENTS-1:0] hpm_events
 );
 
-// CSR LIST
-typedef enum logic [11:0] {    
-    CSR_MCOUNTINHIBIT = 'h320,
-    CSR_MSCRATCH = 'h340,
-    CSR_MCYCLE = 'hB00,
-    CSR_MCYCLEH = 'hB80,
-    CSR_MINSTRET = 'hB02,
-    CSR_MINSTRETH = 'hB82
-} valid_opcodes_t /*verilator public*/;
+localparam int HPM_DEPTH = NUM_HPM_COUNTERS > 0 ? NUM_HPM_COUNTERS : 1;
 
 rv32_word mscratch, next_mscratch;
 
 // Performance counters
 
-// Control
-typedef struct packed {
-    logic cy;
-    logic ir;
-} mcountinhibit_t; 
-mcountinhibit_t mcountinhibit, next_mcountinhibit;
+// Control, bit 0 mcycle, bit 2 minstret, bit 3 up mhpmcounter3 up
+rv32_word mcountinhibit, next_mcountinhibit;
 
 // Counters
 rv64_word mcycle, next_mcycle;
 rv64_word minstret, next_minstret;
 
+// Hardware performance monitor, each counter counts the cycles its event
+// is active
+rv64_word mhpmcounter [HPM_DEPTH];
+rv64_word next_mhpmcounter [HPM_DEPTH];
+hpm_event_t mhpmevent [HPM_DEPTH];
+hpm_event_t next_mhpmevent [HPM_DEPTH];
+
 always_comb begin
     read_value = 0;
 
     // Output control
     case (read_id)
-        CSR_MCOUNTINHIBIT: begin 
-            read_value[0] = mcountinhibit.cy;
-            read_value[2] = mcountinhibit.ir;
+        CSR_MCOUNTINHIBIT: begin
+            read_value = mcountinhibit;
         end
-        CSR_MSCRATCH: begin 
+        CSR_MSCRATCH: begin
             read_value = mscratch;
         end
         CSR_MCYCLE: begin
@@ -65,55 +65,85 @@ always_comb begin
         CSR_MINSTRETH: begin
             read_value = minstret[1];
         end
-        default: read_value = 0; 
+        default: begin
+            for (int k = 0; k < NUM_HPM_COUNTERS; k = k + 1) begin
+                if (read_id == CSR_MHPMEVENT3 + k) read_value = mhpmevent[k];
+                if (read_id == CSR_MHPMCOUNTER3 + k) read_value = mhpmcounter[k][0];
+                if (read_id == CSR_MHPMCOUNTER3H + k) read_value = mhpmcounter[k][1];
+            end
+        end
     endcase
 end
 
 // Write logic
+rv32_word write_value;
 always_comb begin
+    next_mscratch = mscratch;
+    next_mcountinhibit = mcountinhibit;
+    next_mcycle = mcycle;
+    next_minstret = minstret;
+    next_mhpmcounter = mhpmcounter;
+    next_mhpmevent = mhpmevent;
 
     // Counters default behaviour
-    if (!mcountinhibit.cy) next_mcycle = mcycle + 1;
-    if (!mcountinhibit.ir && instr_retired) next_minstret <= minstret + 1;
+    if (!mcountinhibit[0]) next_mcycle = mcycle + 1;
+    if (!mcountinhibit[2] && instr_retired) next_minstret = minstret + 1;
+    for (int k = 0; k < NUM_HPM_COUNTERS; k = k + 1) begin
+        if (!mcountinhibit[3 + k] && hpm_events[mhpmevent[k]])
+            next_mhpmcounter[k] = mhpmcounter[k] + 1;
+    end
 
-    // User write logic
+    // User write logic, legalized as the CSR bypass does
+    write_value = csr_legalize(write_request.id, write_request.value);
     if (write_request.write) begin
         case (write_request.id)
-            CSR_MCOUNTINHIBIT: begin 
-                next_mcountinhibit.cy = write_request.value[0];
-                next_mcountinhibit.ir = write_request.value[2];
+            CSR_MCOUNTINHIBIT: begin
+                next_mcountinhibit = write_value;
             end
-            CSR_MSCRATCH: begin 
-                next_mscratch = write_request.value;
+            CSR_MSCRATCH: begin
+                next_mscratch = write_value;
             end
             CSR_MCYCLE: begin
-                next_mcycle[0] = write_request.value;
+                next_mcycle[0] = write_value;
             end
             CSR_MCYCLEH: begin
-                next_mcycle[1] = write_request.value;
+                next_mcycle[1] = write_value;
             end
             CSR_MINSTRET: begin
-                next_minstret[0] = write_request.value;
+                next_minstret[0] = write_value;
             end
             CSR_MINSTRETH: begin
-                next_minstret[1] = write_request.value;
+                next_minstret[1] = write_value;
+            end
+            default: begin
+                for (int k = 0; k < NUM_HPM_COUNTERS; k = k + 1) begin
+                    if (write_request.id == CSR_MHPMEVENT3 + k)
+                        next_mhpmevent[k] = hpm_event_t'(write_value);
+                    if (write_request.id == CSR_MHPMCOUNTER3 + k)
+                        next_mhpmcounter[k][0] = write_value;
+                    if (write_request.id == CSR_MHPMCOUNTER3H + k)
+                        next_mhpmcounter[k][1] = write_value;
+                end
             end
-            default: ;
         endcase
     end
 end
 
 // Register control
 always_ff @(posedge clk) begin
-    if(!resetn) begin 
+    if(!resetn) begin
         mcycle <= 0;
         minstret <= 0;
         mcountinhibit <= 0;
+        mhpmcounter <= '{default: 0};
+        mhpmevent <= '{default: HPM_EVENT_NONE};
     end else begin
         mcycle <= next_mcycle;
         minstret <= next_minstret;
         mcountinhibit <= next_mcountinhibit;
         mscratch <= next_mscratch;
+        mhpmcounter <= next_mhpmcounter;
+        mhpmevent <= next_mhpmevent;
     end
 end
 
@@ -0,0 +1,324 @@
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off UNUSEDSIGNAL */
+/* verilator lint_off WIDTHEXPAND */
+
+/*
+ Data cache
+ - Set associative, write-back, write allocate, round robin replacement
+ - Addresses from UNCACHED_BASE up (MMIO) go to the bus unchanged
+ - Dirty victims are written back and lines refilled as bursts of word
+   accesses, one per cycle the bus accepts
+ - Hits are served with the same 1 cycle load latency as the BRAM
+ Stores to DCACHE_CTRL_ADDR control the cache, the store completes when
+ the operation is done. Bit 0 writes back the dirty lines, bit 1
+ invalidates all lines. Disabled the cache connects the memory stage to
+ the bus directly and control stores complete at once
+*/
+
+module rv32_dcache
+import rv32_types::*;
+#(
+    parameter int ENABLE = DCACHE,
+    // Bytes, all powers of 2
+    parameter int SIZE = DCACHE_SIZE,
+    parameter int WAYS = DCACHE_WAYS,
+    parameter int LINE = DCACHE_LINE
+) (
+    input logic clk, resetn,
+    // Memory stage port
+    input memory_request_t core_request,
+    output logic core_done,
+    output rv32_word core_data,
+    // Bus port
+    output memory_request_t bus_request,
+    input logic bus_done,
+    input rv32_word bus_data
+);
+
+localparam rv32_word UNCACHED_BASE = 32'h10000000;
+localparam rv32_word DCACHE_CTRL_ADDR = 32'h10800000;
+
+localparam int WORDS = LINE / 4;
+localparam int SETS = SIZE / (LINE * WAYS);
+localparam int WORD_BITS = $clog2(WORDS);
+localparam int SET_BITS = $clog2(SETS);
+localparam int WAY_BITS = WAYS > 1 ? $clog2(WAYS) : 1;
+localparam int TAG_BITS = 30 - WORD_BITS - SET_BITS;
+
+rv32_word lines [WAYS][SETS][WORDS];
+logic [TAG_BITS-1:0] tags [WAYS][SETS];
+logic [WAYS-1:0] valid [SETS];
+logic [WAYS-1:0] dirty [SETS];
+logic [WAY_BITS-1:0] victim [SETS];
+
+// Performance counters, cached requests served or refilled and dirty
+// lines written back
+logic [63:0] hits /*verilator public*/;
+logic [63:0] misses /*verilator public*/;
+logic [63:0] writebacks /*verilator public*/;
+
+typedef enum logic [2:0] {
+    DCACHE_IDLE,
+    DCACHE_WRITEBACK,
+    DCACHE_REFILL,
+    DCACHE_CTRL,
+    DCACHE_CTRL_DONE
+} dcache_state_t;
+dcache_state_t state;
+
+// Line being written back or refilled
+logic [SET_BITS-1:0] line_set;
+logic [WAY_BITS-1:0] line_way;
+logic [TAG_BITS-1:0] line_tag;
+logic [WORD_BITS:0] requested, received;
+// Refill word requested last cycle arrives this cycle
+logic receiving;
+
+// Control operation walk over all lines
+logic [SET_BITS-1:0] walk_set;
+logic [WAY_BITS-1:0] walk_way;
+logic walk_clean, walk_invalidate;
+
+// Load data of the last served request, bus loads are kept from the next
+// cycle as writeback reads it again while the memory stage stalls
+logic bus_served;
+rv32_word load_data;
+
+function automatic rv32_word store_merge(
+    input rv32_word old, input rv32_word data,
+    input mem_op_t op, input logic [1:0] offset
+);
+    rv32_word merged;
+    merged = old;
+    case (op)
+        MEM_SB: merged[offset * 8 +: 8] = data[7:0];
+        MEM_SH: begin
+            if (offset == 2'b00) merged[15:0] = data[15:0];
+            // Misaligned halfwords are not written, as in main memory
+            else if (offset == 2'b10) merged[31:16] = data[15:0];
+        end
+        MEM_SW: merged = data;
+        default: merged = old;
+    endcase
+    return merged;
+endfunction
+
+function automatic rv32_word line_addr(
+    input logic [TAG_BITS-1:0] t, input logic [SET_BITS-1:0] s
+);
+    return {t, s, {(WORD_BITS + 2){1'b0}}};
+endfunction
+
+// Lookup
+logic [WORD_BITS-1:0] word;
+logic [SET_BITS-1:0] set;
+logic [TAG_BITS-1:0] tag;
+logic uncached, ctrl, store, hit;
+logic [WAY_BITS-1:0] hit_way;
+rv32_word hit_data;
+always_comb begin
+    word = core_request.addr[2 +: WORD_BITS];
+    set = core_request.addr[2 + WORD_BITS +: SET_BITS];
+    tag = core_request.addr[31 -: TAG_BITS];
+    uncached = core_request.addr >= UNCACHED_BASE;
+    ctrl = core_request.addr == DCACHE_CTRL_ADDR && core_request.op[3];
+    store = core_request.op[3];
+
+    hit = 0;
+    hit_way = 0;
+    hit_data = 0;
+    for (int way = 0; way < WAYS; way = way + 1) begin
+        if (valid[set][way] && tags[way][set] == tag) begin
+            hit = 1;
+            hit_way = way;
+            hit_data = lines[way][set][word];
+        end
+    end
+end
+
+always_comb begin
+    bus_request.addr = 0;
+    bus_request.data = 0;
+    bus_request.op = MEM_NOP;
+    core_done = 0;
+
+    if (bus_served) core_data = bus_data;
+    else core_data = load_data;
+
+    if (ENABLE == 0) begin
+        core_done = bus_done;
+        core_data = bus_data;
+        bus_request = core_request;
+        if (ctrl) begin
+            core_done = 1;
+            bus_request.op = MEM_NOP;
+        end
+    end
+
+    else case (state)
+        DCACHE_IDLE: begin
+            if (core_request.op == MEM_NOP) core_done = 1;
+            else if (ctrl) core_done = 0;
+            else if (uncached) begin
+                bus_request = core_request;
+                core_done = bus_done;
+            end
+            else core_done = hit;
+        end
+        DCACHE_WRITEBACK: begin
+            bus_request.addr = line_addr(line_tag, line_set) + (requested << 2);
+            bus_request.data = lines[line_way][line_set][requested[WORD_BITS-1:0]];
+            bus_request.op = MEM_SW;
+        end
+        DCACHE_REFILL: begin
+            bus_request.addr = line_addr(line_tag, line_set) + (requested << 2);
+            if (requested != WORDS) bus_request.op = MEM_LW;
+        end
+        DCACHE_CTRL_DONE: core_done = 1;
+        default: ;
+    endcase
+end
+
+always_ff @(posedge clk) begin
+    if (!resetn) begin
+        state <= DCACHE_IDLE;
+        valid <= '{default: 0};
+        dirty <= '{default: 0};
+        victim <= '{default: 0};
+        receiving <= 0;
+        bus_served <= 0;
+        walk_clean <= 0;
+        walk_invalidate <= 0;
+        hits <= 0;
+        misses <= 0;
+        writebacks <= 0;
+    end
+
+    else if (ENABLE != 0) begin
+        if (bus_served) begin
+            load_data <= bus_data;
+            bus_served <= 0;
+        end
+
+        case (state)
+            DCACHE_IDLE: begin
+                if (core_request.op == MEM_NOP) ;
+
+                // Control operation, walk all lines
+                else if (ctrl) begin
+                    state <= DCACHE_CTRL;
+                    walk_set <= 0;
+                    walk_way <= 0;
+                    walk_clean <= core_request.data[0];
+                    walk_invalidate <= core_request.data[1];
+                end
+
+                else if (uncached) begin
+                    if (bus_done) bus_served <= 1;
+                end
+
+                else if (hit) begin
+                    hits <= hits + 1;
+                    if (store) begin
+                        lines[hit_way][set][word] <= store_merge(
+                            hit_data, core_request.data, core_request.op,
+                            core_request.addr[1:0]);
+                        dirty[set][hit_way] <= 1;
+                    end
+                    else load_data <= hit_data;
+                end
+
+                // Miss, replace the victim way
+                else begin
+                    misses <= misses + 1;
+                    line_set <= set;
+                    line_way <= victim[set];
+                    requested <= 0;
+                    received <= 0;
+                    receiving <= 0;
+                    if (WAYS > 1) victim[set] <= victim[set] + 1'b1;
+
+                    if (valid[set][victim[set]] && dirty[set][victim[set]]) begin
+                        state <= DCACHE_WRITEBACK;
+                        line_tag <= tags[victim[set]][set];
+                    end
+                    else begin
+                        state <= DCACHE_REFILL;
+                        line_tag <= tag;
+                    end
+                    valid[set][victim[set]] <= 0;
+                end
+            end
+
+            DCACHE_WRITEBACK: begin
+                if (bus_done) begin
+                    requested <= requested + 1'b1;
+                    // Last word written
+                    if (requested == WORDS - 1) begin
+                        writebacks <= writebacks + 1;
+                        dirty[line_set][line_way] <= 0;
+                        requested <= 0;
+                        // Back to the control walk or refill the missed line
+                        if (walk_clean || walk_invalidate) state <= DCACHE_CTRL;
+                        else begin
+                            state <= DCACHE_REFILL;
+                            line_tag <= tag;
+                        end
+                    end
+                end
+            end
+
+            DCACHE_REFILL: begin
+                if (requested != WORDS && bus_done) requested <= requested + 1'b1;
+                receiving <= requested != WORDS && bus_done;
+
+                if (receiving) begin
+                    lines[line_way][line_set][received[WORD_BITS-1:0]] <= bus_data;
+                    received <= received + 1'b1;
+                    // Last word, the request hits from the next cycle
+                    if (received == WORDS - 1) begin
+                        state <= DCACHE_IDLE;
+                        tags[line_way][line_set] <= line_tag;
+                        valid[line_set][line_way] <= 1;
+                        dirty[line_set][line_way] <= 0;
+                    end
+                end
+            end
+
+            DCACHE_CTRL: begin
+                // Next line
+                walk_way <= walk_way + 1'b1;
+                if (walk_way == WAYS - 1 || WAYS == 1) begin
+                    walk_way <= 0;
+                    walk_set <= walk_set + 1'b1;
+                end
+
+                if (walk_clean && valid[walk_set][walk_way] && dirty[walk_set][walk_way]) begin
+                    // Write back and visit the same line again
+                    state <= DCACHE_WRITEBACK;
+                    line_set <= walk_set;
+                    line_way <= walk_way;
+                    line_tag <= tags[walk_way][walk_set];
+                    requested <= 0;
+                    walk_way <= walk_way;
+                    walk_set <= walk_set;
+                end
+                else begin
+                    if (walk_invalidate) valid[walk_set][walk_way] <= 0;
+                    if (walk_set == SETS - 1 && (walk_way == WAYS - 1 || WAYS == 1))
+                        state <= DCACHE_CTRL_DONE;
+                end
+            end
+
+            DCACHE_CTRL_DONE: begin
+                state <= DCACHE_IDLE;
+                walk_clean <= 0;
+                walk_invalidate <= 0;
+            end
+
+            default: state <= DCACHE_IDLE;
+        endcase
+    end
+end
+
+endmodule
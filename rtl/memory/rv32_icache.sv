@@ -0,0 +1,149 @@
+/* verilator lint_off WIDTHTRUNC */
+/* verilator lint_off UNUSEDSIGNAL */
+/* verilator lint_off WIDTHEXPAND */
+
+/*
+ Instruction cache
+ - Set associative, round robin replacement
+ - Line refill as a burst of word reads, one request per cycle the
+   backing memory accepts
+ - Hits are served with the same 1 cycle latency as the BRAM
+ Disabled it connects fetch to the memory port directly
+ There is no invalidation, code written by stores is not seen by fetch
+*/
+
+module rv32_icache
+import rv32_types::*;
+#(
+    parameter int ENABLE = ICACHE,
+    // Bytes, all powers of 2
+    parameter int SIZE = ICACHE_SIZE,
+    parameter int WAYS = ICACHE_WAYS,
+    parameter int LINE = ICACHE_LINE
+) (
+    input logic clk, resetn,
+    // Fetch port
+    input memory_request_t core_request,
+    output logic core_done,
+    output rv32_word core_instr,
+    // Backing memory port
+    output memory_request_t mem_request,
+    input logic mem_done,
+    input rv32_word mem_data
+);
+
+localparam int WORDS = LINE / 4;
+localparam int SETS = SIZE / (LINE * WAYS);
+localparam int WORD_BITS = $clog2(WORDS);
+localparam int SET_BITS = $clog2(SETS);
+localparam int WAY_BITS = WAYS > 1 ? $clog2(WAYS) : 1;
+localparam int TAG_BITS = 30 - WORD_BITS - SET_BITS;
+
+rv32_word lines [WAYS][SETS][WORDS];
+logic [TAG_BITS-1:0] tags [WAYS][SETS];
+logic [WAYS-1:0] valid [SETS];
+logic [WAY_BITS-1:0] victim [SETS];
+
+// Performance counters, fetch requests served or refilled
+logic [63:0] hits /*verilator public*/;
+logic [63:0] misses /*verilator public*/;
+
+// Refill state
+logic refilling;
+rv32_word refill_addr;
+logic [SET_BITS-1:0] refill_set;
+logic [TAG_BITS-1:0] refill_tag;
+logic [WAY_BITS-1:0] refill_way;
+logic [WORD_BITS:0] requested, received;
+// Word requested last cycle arrives this cycle
+logic receiving;
+
+// Lookup
+logic [WORD_BITS-1:0] word;
+logic [SET_BITS-1:0] set;
+logic [TAG_BITS-1:0] tag;
+logic hit;
+rv32_word hit_data, cached_instr;
+always_comb begin
+    word = core_request.addr[2 +: WORD_BITS];
+    set = core_request.addr[2 + WORD_BITS +: SET_BITS];
+    tag = core_request.addr[31 -: TAG_BITS];
+
+    hit = 0;
+    hit_data = 0;
+    for (int way = 0; way < WAYS; way = way + 1) begin
+        if (valid[set][way] && tags[way][set] == tag) begin
+            hit = 1;
+            hit_data = lines[way][set][word];
+        end
+    end
+end
+
+always_comb begin
+    if (ENABLE != 0) begin
+        core_done = hit && !refilling;
+        core_instr = cached_instr;
+
+        mem_request.addr = refill_addr + (requested << 2);
+        mem_request.data = 0;
+        if (refilling && requested != WORDS) mem_request.op = MEM_LW;
+        else mem_request.op = MEM_NOP;
+    end
+    else begin
+        core_done = mem_done;
+        core_instr = mem_data;
+        mem_request = core_request;
+    end
+end
+
+always_ff @(posedge clk) begin
+    if (!resetn) begin
+        valid <= '{default: 0};
+        victim <= '{default: 0};
+        refilling <= 0;
+        receiving <= 0;
+        hits <= 0;
+        misses <= 0;
+    end
+
+    else if (ENABLE != 0 && !refilling) begin
+        if (core_request.op == MEM_LW) begin
+            if (hit) begin
+                hits <= hits + 1;
+                cached_instr <= hit_data;
+            end
+            // Start the refill of the victim way
+            else begin
+                misses <= misses + 1;
+                refilling <= 1;
+                refill_addr <= {core_request.addr[31:2 + WORD_BITS], {(WORD_BITS + 2){1'b0}}};
+                refill_set <= set;
+                refill_tag <= tag;
+                refill_way <= victim[set];
+                valid[set][victim[set]] <= 0;
+                if (WAYS > 1) victim[set] <= victim[set] + 1'b1;
+                requested <= 0;
+                received <= 0;
+                receiving <= 0;
+            end
+        end
+    end
+
+    else if (ENABLE != 0) begin
+        if (requested != WORDS && mem_done) requested <= requested + 1'b1;
+        receiving <= requested != WORDS && mem_done;
+
+        if (receiving) begin
+            lines[refill_way][refill_set][received[WORD_BITS-1:0]] <= mem_data;
+            received <= received + 1'b1;
+            // Last word, the line is valid from the next cycle
+            if (received == WORDS - 1) begin
+                refilling <= 0;
+                tags[refill_way][refill_set] <= refill_tag;
+                valid[refill_set][refill_way] <= 1;
+            end
+        end
+    end
+end
+
+endmodule
@@ -15,6 +15,16 @@ import rv32_types::*;
 logic instr_request_done /*verilator public*/;
 rv32_word instr /*verilator public*/;
 
+// Core fetch signals, served by the instruction cache
+memory_request_t fetch_request /*verilator public*/;
+logic fetch_request_done /*verilator public*/;
+rv32_word fetch_instr /*verilator public*/;
+
+// Core memory stage signals, served by the data cache
+memory_request_t mem_request /*verilator public*/;
+logic mem_request_done /*verilator public*/;
+rv32_word mem_data /*verilator public*/;
+
 // Data bus signals
 rv32_word core_data /*verilator public*/;
 logic core_data_ready;
@@ -22,13 +32,37 @@ logic core_data_ready;
 rv32_core core (
     .clk(clk), .resetn(resetn),
     // Instruction
-    .instr_request(core_instr_request),
-    .instr_request_done(instr_request_done),
-    .instr(instr),
+    .instr_request(fetch_request),
+    .instr_request_done(fetch_request_done),
+    .instr(fetch_instr),
     // Data
-    .data_request(mmio_data_request),
-    .data_request_done(core_data_ready),
-    .data(core_data)
+    .data_request(mem_request),
+    .data_request_done(mem_request_done),
+    .data(mem_data)
+);
+
+rv32_icache icache (
+    .clk(clk), .resetn(resetn),
+    // Fetch
+    .core_request(fetch_request),
+    .core_done(fetch_request_done),
+    .core_instr(fetch_instr),
+    // Memory
+    .mem_request(core_instr_request),
+    .mem_done(instr_request_done),
+    .mem_data(instr)
+);
+
+rv32_dcache dcache (
+    .clk(clk), .resetn(resetn),
+    // Memory stage
+    .core_request(mem_request),
+    .core_done(mem_request_done),
+    .core_data(mem_data),
+    // Data bus
+    .bus_request(mmio_data_request),
+    .bus_done(core_data_ready),
+    .bus_data(core_data)
 );
 
 logic mem_data_ready /*verilator public*/;
@@ -2,6 +2,134 @@ package rv32_types;
 
 // Definitions for all data types, structs, etc...
 
+// Core configuration
+// Defaults can be overriden with verilator -D flags (RTL_CONFIG in Makefile)
+
+// Branch predictor
+// 0 none, every taken branch/jump flushes fetch and decode
+// 1 bimodal, 2 gshare
+`ifndef RV32_BRANCH_PREDICTOR
+`define RV32_BRANCH_PREDICTOR 0
+`endif
+// Power of 2 number of entries, at least 2
+`ifndef RV32_BTB_ENTRIES
+`define RV32_BTB_ENTRIES 64
+`endif
+// Power of 2 number of 2-bit counters, up to 65536
+`ifndef RV32_BHT_ENTRIES
+`define RV32_BHT_ENTRIES 256
+`endif
+// Global history bits for gshare, 2 up to log2(RV32_BHT_ENTRIES)
+`ifndef RV32_BP_HISTORY_BITS
+`define RV32_BP_HISTORY_BITS 8
+`endif
+// Power of 2 number of return addresses, at least 2
+`ifndef RV32_RAS_ENTRIES
+`define RV32_RAS_ENTRIES 8
+`endif
+
+// Unconditional jumps resolved in decode, 1 cycle flush instead of 2
+// 0 none, 1 JAL, 2 JAL and JALR when rs1 has no pending write
+`ifndef RV32_EARLY_JUMP
+`define RV32_EARLY_JUMP 0
+`endif
+
+// Multiplier pipeline stages
+// 1 combinational unit in exec, 2 or 3 pipelined across exec, mem and
+// writeback, the result is ready at writeback
+`ifndef RV32_MUL_STAGES
+`define RV32_MUL_STAGES 1
+`endif
+
+// Divider quotient bits per cycle, 2 or 4
+`ifndef RV32_DIV_RADIX
+`define RV32_DIV_RADIX 4
+`endif
+
+// Instruction queue entries between fetch and decode, 0 disabled
+`ifndef RV32_FETCH_QUEUE
+`define RV32_FETCH_QUEUE 0
+`endif
+
+// Instruction cache between fetch and the instruction memory port
+// 0 disabled, 1 enabled
+`ifndef RV32_ICACHE
+`define RV32_ICACHE 0
+`endif
+// Bytes, powers of 2, at least 2 sets and 2 words per line
+`ifndef RV32_ICACHE_SIZE
+`define RV32_ICACHE_SIZE 4096
+`endif
+`ifndef RV32_ICACHE_WAYS
+`define RV32_ICACHE_WAYS 2
+`endif
+`ifndef RV32_ICACHE_LINE
+`define RV32_ICACHE_LINE 16
+`endif
+
+// Write-back data cache between the memory stage and the data bus
+// 0 disabled, 1 enabled
+`ifndef RV32_DCACHE
+`define RV32_DCACHE 0
+`endif
+// Bytes, powers of 2, at least 2 sets and 2 words per line
+`ifndef RV32_DCACHE_SIZE
+`define RV32_DCACHE_SIZE 4096
+`endif
+`ifndef RV32_DCACHE_WAYS
+`define RV32_DCACHE_WAYS 2
+`endif
+`ifndef RV32_DCACHE_LINE
+`define RV32_DCACHE_LINE 16
+`endif
+
+// Store buffer entries in the memory stage, 0 disabled
+`ifndef RV32_STORE_BUFFER
+`define RV32_STORE_BUFFER 0
+`endif
+
+// Hardware performance monitor counters, mhpmcounter3 up, 0 to 6
+// Must match NUM_HPM_COUNTERS of the BSP config.h
+`ifndef RV32_HPM_COUNTERS
+`define RV32_HPM_COUNTERS 2
+`endif
+
+localparam int BP_NONE = 0;
+localparam int BP_BIMODAL = 1;
+localparam int BP_GSHARE = 2;
+
+localparam int BRANCH_PREDICTOR = `RV32_BRANCH_PREDICTOR;
+localparam int BTB_ENTRIES = `RV32_BTB_ENTRIES;
+localparam int BHT_ENTRIES = `RV32_BHT_ENTRIES;
+localparam int BP_HISTORY_BITS = `RV32_BP_HISTORY_BITS;
+localparam int RAS_ENTRIES = `RV32_RAS_ENTRIES;
+
+localparam int EARLY_JUMP_NONE = 0;
+localparam int EARLY_JUMP_JAL = 1;
+localparam int EARLY_JUMP_JALR = 2;
+
+localparam int EARLY_JUMP = `RV32_EARLY_JUMP;
+
+localparam int MUL_STAGES = `RV32_MUL_STAGES;
+
+localparam int DIV_RADIX = `RV32_DIV_RADIX;
+
+localparam int FETCH_QUEUE = `RV32_FETCH_QUEUE;
+
+localparam int ICACHE = `RV32_ICACHE;
+localparam int ICACHE_SIZE = `RV32_ICACHE_SIZE;
+localparam int ICACHE_WAYS = `RV32_ICACHE_WAYS;
+localparam int ICACHE_LINE = `RV32_ICACHE_LINE;
+
+localparam int DCACHE = `RV32_DCACHE;
+localparam int DCACHE_SIZE = `RV32_DCACHE_SIZE;
+localparam int DCACHE_WAYS = `RV32_DCACHE_WAYS;
+localparam int DCACHE_LINE = `RV32_DCACHE_LINE;
+
+localparam int STORE_BUFFER = `RV32_STORE_BUFFER;
+
+localparam int HPM_COUNTERS = `RV32_HPM_COUNTERS;
+
 typedef logic[31:0] rv32_word;
 typedef rv32_word [1:0] rv64_word;
 
@@ -118,7 +246,8 @@ typedef enum logic [2:0] {
     WB_STORE,
     WB_MUL_UNIT,
     WB_GRNG,
-    WB_CSR
+    WB_CSR,
+    WB_DIV_UNIT
 } wb_result_t /*verilator public*/;
 
 typedef enum logic [2:0] {
@@ -158,6 +287,7 @@ typedef struct packed {
     instr_type_t t;
     // Bypass
     bypass_t [2:0] bypass_rs;
+    bypass_t bypass_csr;
     // Branch
     branch_op_t branch_op;
     // Int Alu
@@ -182,6 +312,7 @@ function automatic rv_control_t create_nop_ctrl();
     instr.bypass_rs[0] = NO_BYPASS;
     instr.bypass_rs[1] = NO_BYPASS;
     instr.bypass_rs[2] = NO_BYPASS;
+    instr.bypass_csr = NO_BYPASS;
     instr.branch_op = OP_NOP;
     instr.int_alu_instr = create_alu_nop_instr();
     instr.grng_ctrl = create_grng_nop_ctrl();
@@ -204,19 +335,119 @@ typedef struct packed {
     logic write;
 } csr_write_request_t /*verilator public*/;
 
+// Hardware performance monitor events, mhpmevent values
+typedef enum logic [3:0] {
+    HPM_EVENT_NONE,
+    // Cycles decode sends a bubble for a load use
+    HPM_EVENT_LOAD_USE,
+    // Cycles the memory stage stalls
+    HPM_EVENT_MEM_STALL,
+    // Exec redirects, mispredicted branches and jumps
+    HPM_EVENT_BRANCH_FLUSH,
+    // Taken branches and jumps resolved in exec
+    HPM_EVENT_BRANCH_TAKEN,
+    // Loads and stores leaving the memory stage
+    HPM_EVENT_LOAD_STORE,
+    // MUL and GRNG instructions leaving the memory stage
+    HPM_EVENT_MUL_GRNG
+} hpm_event_t /*verilator public*/;
+localparam int HPM_EVENTS = 7;
+
+// CSRs of the core
+typedef enum logic [11:0] {
+    CSR_MCOUNTINHIBIT = 'h320,
+    CSR_MHPMEVENT3 = 'h323,
+    CSR_MSCRATCH = 'h340,
+    CSR_MCYCLE = 'hB00,
+    CSR_MCYCLEH = 'hB80,
+    CSR_MINSTRET = 'hB02,
+    CSR_MINSTRETH = 'hB82,
+    CSR_MHPMCOUNTER3 = 'hB03,
+    CSR_MHPMCOUNTER3H = 'hB83
+} csr_id_t /*verilator public*/;
+
+// mcountinhibit keeps all bits but bit 1, bits of counters not implemented
+// have no effect
+localparam rv32_word MCOUNTINHIBIT_MASK = 32'hfffffffd;
+
+// Value a CSR keeps after a write, what a later read gives
+// CSRs not implemented read 0, mhpmevent values out of hpm_event_t select
+// HPM_EVENT_NONE. Used by the CSR file and the CSR bypass
+function automatic rv32_word csr_legalize(input rv_csr_id_t id, input rv32_word value);
+    rv32_word legal;
+    legal = 0;
+    case (id)
+        CSR_MCOUNTINHIBIT: legal = value & MCOUNTINHIBIT_MASK;
+        CSR_MSCRATCH, CSR_MCYCLE, CSR_MCYCLEH, CSR_MINSTRET, CSR_MINSTRETH: legal = value;
+        default: begin
+            for (int k = 0; k < HPM_COUNTERS; k = k + 1) begin
+                if (id == CSR_MHPMEVENT3 + k && value < HPM_EVENTS) legal = value;
+                if (id == CSR_MHPMCOUNTER3 + k || id == CSR_MHPMCOUNTER3H + k) legal = value;
+            end
+        end
+    endcase
+    return legal;
+endfunction
+
+// Branch target buffer entry kinds
+// Calls push and returns pop the return address stack
+typedef enum logic [1:0] {
+    BTB_BRANCH,
+    BTB_JUMP,
+    BTB_CALL,
+    BTB_RET
+} btb_kind_t /*verilator public*/;
+
+// Prediction made at fetch, travels with the instruction until exec
+typedef struct packed {
+    logic taken;
+    rv32_word target;
+    // Direction counter used, trained with the outcome
+    logic [15:0] bht_index;
+} branch_prediction_t /*verilator public*/;
+
+function automatic branch_prediction_t create_not_taken_prediction();
+    branch_prediction_t prediction;
+    prediction.taken = 0;
+    prediction.target = 0;
+    prediction.bht_index = 0;
+    return prediction;
+endfunction
+
+// Outcome of the instruction leaving exec
+typedef struct packed {
+    logic valid;
+    // Branch or jump, otherwise a non control flow instruction mispredicted
+    // as taken by a stale BTB entry
+    logic control_flow;
+    logic conditional;
+    btb_kind_t kind;
+    logic taken;
+    logic mispredict;
+    rv32_word pc;
+    rv32_word target;
+    logic [15:0] bht_index;
+} branch_resolution_t /*verilator public*/;
+
 typedef struct packed {
     rv32_word pc;
     logic generate_nop;
+    branch_prediction_t prediction;
 } fetch_decode_buffer_t /*verilator public*/;
 
 typedef struct packed {
+    // Holds an instruction, cleared for bubbles. A program can execute
+    // RV_NOP itself, so it is not used to tell them apart
+    logic valid;
     rv_instr_t instr;
     rv32_word pc;
     rv_control_t control;
     rv32_word[2:0] reg_data;
+    branch_prediction_t prediction;
 } decode_exec_buffer_t /*verilator public*/;
 
 typedef struct packed {
+    logic valid;
     rv_instr_t instr;
     rv32_word pc;
     rv_control_t control;
@@ -0,0 +1,38 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+
+#include <riscv/types.h>
+#include <riscv/profiler/external.h>
+
+// Benchmark support
+// The measured kernel runs inside the external profiler region
+// BENCH_REGION, the simulator counts its cycles and instructions without
+// any overhead in the core. The work done is printed at the end as
+//   BENCH <units> <unit name>
+// and run_bench.py turns both into the benchmark score
+
+#define BENCH_REGION 1
+
+inline void bench_start(const char* name) {
+    set_external_region_name(BENCH_REGION, name);
+    start_external_region(BENCH_REGION);
+}
+
+inline void bench_stop(const uint32 units, const char* unit) {
+    stop_external_region(BENCH_REGION);
+    printf("BENCH %lu %s\n", (unsigned long) units, unit);
+}
+
+// Kernel results are checked against the expected value
+inline int bench_check(const uint32 value, const uint32 expected) {
+    if (value != expected) {
+        printf("BENCH check failed 0x%08lx != 0x%08lx\n",
+            (unsigned long) value, (unsigned long) expected);
+        return 1;
+    }
+    return 0;
+}
+
+#endif
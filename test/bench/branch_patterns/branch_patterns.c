@@ -0,0 +1,66 @@
+// Control flow heavy kernels for the branch predictor
+// - Loop with a data dependent branch following a repeating pattern, only
+//   learnt with global history
+// - Recursive calls and returns, predicted with the return address stack
+// - Dispatch through a table of function pointers, indirect jumps whose
+//   target is stored in the BTB
+// Score is kernel iterations per Mcycle
+
+#include <riscv/types.h>
+
+#include "../bench.h"
+
+#define ITERATIONS 8
+#define PATTERN_LENGTH 256
+#define FIB_N 12
+#define DISPATCH_LENGTH 256
+
+#define NOINLINE __attribute__((noinline))
+
+static uint8 pattern[PATTERN_LENGTH];
+static uint8 ops[DISPATCH_LENGTH];
+
+NOINLINE static uint32 pattern_loop(void) {
+    uint32 acc = 0;
+    for (uint32 i = 0; i < PATTERN_LENGTH; i++) {
+        // Taken, taken, not taken, taken, ...
+        if (pattern[i]) acc += i;
+        else acc ^= i << 3;
+    }
+    return acc;
+}
+
+NOINLINE static uint32 fib(uint32 n) {
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+NOINLINE static uint32 op_add(uint32 a) { return a + 7; }
+NOINLINE static uint32 op_xor(uint32 a) { return a ^ 0x5a5a; }
+NOINLINE static uint32 op_rot(uint32 a) { return (a << 5) | (a >> 27); }
+NOINLINE static uint32 op_sub(uint32 a) { return a - 3; }
+
+typedef uint32 (*op_t)(uint32);
+static const op_t op_table[4] = {op_add, op_xor, op_rot, op_sub};
+
+NOINLINE static uint32 dispatch(uint32 a) {
+    for (uint32 i = 0; i < DISPATCH_LENGTH; i++) a = op_table[ops[i]](a);
+    return a;
+}
+
+int main() {
+    for (uint32 i = 0; i < PATTERN_LENGTH; i++) pattern[i] = (i & 3) != 2;
+    // Short repeating sequence of operations
+    for (uint32 i = 0; i < DISPATCH_LENGTH; i++) ops[i] = (i * 3 + (i >> 2)) & 3;
+
+    uint32 checksum = 0;
+    bench_start("branch_patterns");
+    for (uint32 it = 0; it < ITERATIONS; it++) {
+        checksum = checksum * 31 + pattern_loop();
+        checksum = checksum * 31 + fib(FIB_N);
+        checksum = checksum * 31 + dispatch(checksum);
+    }
+    bench_stop(ITERATIONS, "iterations");
+
+    return bench_check(checksum, 0x8eda5ad4);
+}
@@ -0,0 +1,289 @@
+// CoreMark style integer benchmark
+// Each iteration runs the 3 classic workloads over the same seeded data:
+// - Linked list find, reverse and merge sort
+// - Small int16 matrix multiply with constant and bit extract variants
+// - State machine scanning a buffer of numeric tokens
+// Every result is folded into a CRC16, score is iterations per Mcycle
+
+#include <riscv/types.h>
+
+#include "../bench.h"
+
+#define ITERATIONS 20
+
+#define NOINLINE __attribute__((noinline))
+
+// CRC16 CCITT reflected, 1 bit per step like the reference
+static uint16 crcu8(uint8 data, uint16 crc) {
+    for (uint8 i = 0; i < 8; i++) {
+        uint8 x16 = (data & 1) ^ (crc & 1);
+        data >>= 1;
+        crc >>= 1;
+        if (x16) crc ^= 0xa001;
+    }
+    return crc;
+}
+
+static uint16 crcu16(uint16 v, uint16 crc) {
+    crc = crcu8((uint8) v, crc);
+    return crcu8((uint8) (v >> 8), crc);
+}
+
+static uint16 crc32(uint32 v, uint16 crc) {
+    crc = crcu16((uint16) v, crc);
+    return crcu16((uint16) (v >> 16), crc);
+}
+
+// Linked list
+
+#define LIST_SIZE 64
+
+typedef struct list_node {
+    struct list_node* next;
+    int16 data;
+    int16 idx;
+} list_node;
+
+static list_node nodes[LIST_SIZE];
+
+static list_node* list_init(uint16 seed) {
+    for (int32 i = 0; i < LIST_SIZE; i++) {
+        seed = (uint16) (seed * 25173 + 13849);
+        nodes[i].data = (int16) (seed & 0x7fff);
+        nodes[i].idx = (int16) i;
+        nodes[i].next = i + 1 < LIST_SIZE ? &nodes[i + 1] : NULL;
+    }
+    return &nodes[0];
+}
+
+NOINLINE static list_node* list_find(list_node* list, int16 data) {
+    while (list && (list->data & 0xff) != (data & 0xff)) list = list->next;
+    return list;
+}
+
+NOINLINE static list_node* list_reverse(list_node* list) {
+    list_node* prev = NULL;
+    while (list) {
+        list_node* next = list->next;
+        list->next = prev;
+        prev = list;
+        list = next;
+    }
+    return prev;
+}
+
+static int32 cmp_data(const list_node* a, const list_node* b) {
+    return a->data - b->data;
+}
+
+static int32 cmp_idx(const list_node* a, const list_node* b) {
+    return a->idx - b->idx;
+}
+
+// Bottom up merge sort, no recursion and no extra memory
+NOINLINE static list_node* list_sort(list_node* list,
+    int32 (*cmp)(const list_node*, const list_node*)) {
+
+    for (int32 insize = 1; ; insize *= 2) {
+        list_node* p = list;
+        list_node* tail = NULL;
+        int32 merges = 0;
+        list = NULL;
+
+        while (p) {
+            merges++;
+            list_node* q = p;
+            int32 psize = 0;
+            for (int32 i = 0; i < insize && q; i++) {
+                psize++;
+                q = q->next;
+            }
+            int32 qsize = insize;
+
+            while (psize > 0 || (qsize > 0 && q)) {
+                list_node* e;
+                if (psize == 0) { e = q; q = q->next; qsize--; }
+                else if (qsize == 0 || !q) { e = p; p = p->next; psize--; }
+                else if (cmp(p, q) <= 0) { e = p; p = p->next; psize--; }
+                else { e = q; q = q->next; qsize--; }
+
+                if (tail) tail->next = e;
+                else list = e;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->next = NULL;
+        if (merges <= 1) return list;
+    }
+}
+
+static uint16 bench_list(uint16 seed, uint16 crc) {
+    list_node* list = list_init(seed);
+
+    for (int16 i = 0; i < 8; i++) {
+        list_node* found = list_find(list, (int16) (seed + i * 37));
+        crc = crcu16(found ? (uint16) found->idx : 0xffff, crc);
+        list = list_reverse(list);
+    }
+
+    list = list_sort(list, cmp_data);
+    for (list_node* n = list; n; n = n->next) crc = crcu16((uint16) n->data, crc);
+    list = list_sort(list, cmp_idx);
+    crc = crcu16((uint16) list->next->next->data, crc);
+    return crc;
+}
+
+// Matrix
+
+#define MAT_N 12
+
+static int16 mat_a[MAT_N][MAT_N], mat_b[MAT_N][MAT_N];
+static int32 mat_c[MAT_N][MAT_N];
+
+NOINLINE static void matrix_mul(void) {
+    for (int32 i = 0; i < MAT_N; i++) {
+        for (int32 j = 0; j < MAT_N; j++) {
+            int32 acc = 0;
+            for (int32 k = 0; k < MAT_N; k++) acc += mat_a[i][k] * mat_b[k][j];
+            mat_c[i][j] = acc;
+        }
+    }
+}
+
+NOINLINE static void matrix_add_const(int16 v) {
+    for (int32 i = 0; i < MAT_N; i++) {
+        for (int32 j = 0; j < MAT_N; j++) mat_a[i][j] += v;
+    }
+}
+
+NOINLINE static int32 matrix_sum_bits(void) {
+    int32 sum = 0;
+    for (int32 i = 0; i < MAT_N; i++) {
+        for (int32 j = 0; j < MAT_N; j++) sum += (mat_c[i][j] >> 2) & 0x7f;
+    }
+    return sum;
+}
+
+static uint16 bench_matrix(uint16 seed, uint16 crc) {
+    for (int32 i = 0; i < MAT_N; i++) {
+        for (int32 j = 0; j < MAT_N; j++) {
+            seed = (uint16) (seed * 25173 + 13849);
+            mat_a[i][j] = (int16) ((seed >> 4) & 0xff) - 128;
+            mat_b[i][j] = (int16) ((seed >> 8) & 0xff) - 128;
+        }
+    }
+
+    matrix_mul();
+    crc = crcu16((uint16) matrix_sum_bits(), crc);
+    matrix_add_const((int16) seed);
+    matrix_mul();
+    crc = crcu16((uint16) matrix_sum_bits(), crc);
+    crc = crc32((uint32) mat_c[MAT_N - 1][MAT_N - 1], crc);
+    return crc;
+}
+
+// State machine
+
+#define STATE_BYTES 256
+
+typedef enum {
+    STATE_START, STATE_INT, STATE_FLOAT, STATE_EXP, STATE_SCI, STATE_INVALID,
+    NUM_STATES
+} state_t;
+
+static char state_buffer[STATE_BYTES];
+
+static const char* const tokens[] = {
+    "5012", "1234", "-874", "+122", "35.54", "0.041", "-110.7", "1.000",
+    "5.5e+3", "-.123e-2", "-87e+832", "+0.6e-12", "T0.3e-1F", "-T.T++Tq",
+    "1T3.4e4z", "34.0e-T^"
+};
+
+static void state_init(uint16 seed) {
+    int32 p = 0;
+    while (1) {
+        seed = (uint16) (seed * 25173 + 13849);
+        const char* t = tokens[(seed >> 8) & 0xf];
+        int32 len = 0;
+        while (t[len]) len++;
+        if (p + len + 1 >= STATE_BYTES) break;
+        for (int32 i = 0; i < len; i++) state_buffer[p++] = t[i];
+        state_buffer[p++] = ',';
+    }
+    state_buffer[p] = 0;
+}
+
+static int32 is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+NOINLINE static state_t next_state(const char** str, uint32* transitions) {
+    const char* s = *str;
+    state_t state = STATE_START;
+
+    for (; *s && *s != ','; s++) {
+        char c = *s;
+        switch (state) {
+            case STATE_START:
+                if (is_digit(c)) state = STATE_INT;
+                else if (c == '+' || c == '-') state = STATE_INT;
+                else if (c == '.') state = STATE_FLOAT;
+                else { state = STATE_INVALID; transitions[STATE_INVALID]++; }
+                transitions[STATE_START]++;
+                break;
+            case STATE_INT:
+                if (c == '.') { state = STATE_FLOAT; transitions[STATE_INT]++; }
+                else if (!is_digit(c)) { state = STATE_INVALID; transitions[STATE_INT]++; }
+                break;
+            case STATE_FLOAT:
+                if (c == 'E' || c == 'e') { state = STATE_EXP; transitions[STATE_FLOAT]++; }
+                else if (!is_digit(c)) { state = STATE_INVALID; transitions[STATE_FLOAT]++; }
+                break;
+            case STATE_EXP:
+                if (c == '+' || c == '-') state = STATE_SCI;
+                else state = STATE_INVALID;
+                transitions[STATE_EXP]++;
+                break;
+            case STATE_SCI:
+                if (!is_digit(c)) { state = STATE_INVALID; transitions[STATE_INVALID]++; }
+                break;
+            default:
+                break;
+        }
+    }
+    *str = *s ? s + 1 : s;
+    return state;
+}
+
+static uint16 bench_state(uint16 seed, uint16 crc) {
+    uint32 final_counts[NUM_STATES] = {0};
+    uint32 transitions[NUM_STATES] = {0};
+
+    state_init(seed);
+    const char* p = state_buffer;
+    while (*p) final_counts[next_state(&p, transitions)]++;
+
+    for (int32 i = 0; i < NUM_STATES; i++) {
+        crc = crc32(final_counts[i], crc);
+        crc = crc32(transitions[i], crc);
+    }
+    return crc;
+}
+
+int main() {
+    uint16 crc = 0;
+
+    bench_start("coremark");
+
+    for (uint16 i = 0; i < ITERATIONS; i++) {
+        uint16 seed = (uint16) (0x3415 + i);
+        crc = bench_list(seed, crc);
+        crc = bench_matrix(seed, crc);
+        crc = bench_state(seed, crc);
+    }
+
+    bench_stop(ITERATIONS, "iterations");
+
+    return bench_check(crc, 0x7ac2);
+}
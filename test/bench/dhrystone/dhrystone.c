@@ -0,0 +1,231 @@
+// Dhrystone 2.1 style integer benchmark
+// Record copies, string copy/compare, enum switches, array indexing and
+// procedure calls, the procedures are kept out of line like the original
+// build rules require. Score is reported as DMIPS/MHz
+
+#include <string.h>
+
+#include <riscv/types.h>
+
+#include "../bench.h"
+
+#define RUNS 2000
+
+#define NOINLINE __attribute__((noinline))
+
+typedef enum { IDENT_1, IDENT_2, IDENT_3, IDENT_4, IDENT_5 } enumeration;
+
+typedef char str_30[31];
+typedef int32 arr_1_dim[50];
+typedef int32 arr_2_dim[50][50];
+
+typedef struct record {
+    struct record* ptr_comp;
+    enumeration discr;
+    union {
+        struct {
+            enumeration enum_comp;
+            int32 int_comp;
+            str_30 str_comp;
+        } var_1;
+        struct {
+            enumeration enum_comp_2;
+            str_30 str_comp_2;
+        } var_2;
+        struct {
+            char ch_1_comp;
+            char ch_2_comp;
+        } var_3;
+    } variant;
+} record;
+
+static record rec_a, rec_b;
+static record* ptr_glob;
+static record* next_ptr_glob;
+static int32 int_glob;
+static int32 bool_glob;
+static char ch_1_glob, ch_2_glob;
+static arr_1_dim arr_1_glob;
+static arr_2_dim arr_2_glob;
+
+NOINLINE static void proc_7(int32 int_1, int32 int_2, int32* int_ref) {
+    int32 int_loc = int_1 + 2;
+    *int_ref = int_2 + int_loc;
+}
+
+NOINLINE static int32 func_3(enumeration enum_val) {
+    return enum_val == IDENT_3;
+}
+
+NOINLINE static enumeration func_1(char ch_1, char ch_2) {
+    char ch_1_loc = ch_1;
+    char ch_2_loc = ch_1_loc;
+    if (ch_2_loc != ch_2) return IDENT_1;
+    ch_1_glob = ch_1_loc;
+    return IDENT_2;
+}
+
+NOINLINE static int32 func_2(str_30 str_1, str_30 str_2) {
+    int32 int_loc = 2;
+    char ch_loc = 0;
+
+    while (int_loc <= 2) {
+        if (func_1(str_1[int_loc], str_2[int_loc + 1]) == IDENT_1) {
+            ch_loc = 'A';
+            int_loc += 1;
+        }
+    }
+    if (ch_loc >= 'W' && ch_loc < 'Z') int_loc = 7;
+    if (ch_loc == 'R') return 1;
+    if (strcmp(str_1, str_2) > 0) {
+        int_loc += 7;
+        int_glob = int_loc;
+        return 1;
+    }
+    return 0;
+}
+
+NOINLINE static void proc_6(enumeration enum_val, enumeration* enum_ref) {
+    *enum_ref = enum_val;
+    if (!func_3(enum_val)) *enum_ref = IDENT_4;
+    switch (enum_val) {
+        case IDENT_1: *enum_ref = IDENT_1; break;
+        case IDENT_2:
+            if (int_glob > 100) *enum_ref = IDENT_1;
+            else *enum_ref = IDENT_4;
+            break;
+        case IDENT_3: *enum_ref = IDENT_2; break;
+        case IDENT_4: break;
+        case IDENT_5: *enum_ref = IDENT_3; break;
+    }
+}
+
+NOINLINE static void proc_8(arr_1_dim arr_1, arr_2_dim arr_2, int32 int_1, int32 int_2) {
+    int32 int_loc = int_1 + 5;
+    arr_1[int_loc] = int_2;
+    arr_1[int_loc + 1] = arr_1[int_loc];
+    arr_1[int_loc + 30] = int_loc;
+    for (int32 i = int_loc; i <= int_loc + 1; i++) arr_2[int_loc][i] = int_loc;
+    arr_2[int_loc][int_loc - 1] += 1;
+    arr_2[int_loc + 20][int_loc] = arr_1[int_loc];
+    int_glob = 5;
+}
+
+NOINLINE static void proc_3(record** ptr_ref) {
+    if (ptr_glob != NULL) *ptr_ref = ptr_glob->ptr_comp;
+    proc_7(10, int_glob, &ptr_glob->variant.var_1.int_comp);
+}
+
+NOINLINE static void proc_1(record* ptr_val) {
+    record* next = ptr_val->ptr_comp;
+
+    *ptr_val->ptr_comp = *ptr_glob;
+    ptr_val->variant.var_1.int_comp = 5;
+    next->variant.var_1.int_comp = ptr_val->variant.var_1.int_comp;
+    next->ptr_comp = ptr_val->ptr_comp;
+    proc_3(&next->ptr_comp);
+
+    if (next->discr == IDENT_1) {
+        next->variant.var_1.int_comp = 6;
+        proc_6(ptr_val->variant.var_1.enum_comp, &next->variant.var_1.enum_comp);
+        next->ptr_comp = ptr_glob->ptr_comp;
+        proc_7(next->variant.var_1.int_comp, 10, &next->variant.var_1.int_comp);
+    } else {
+        *ptr_val = *ptr_val->ptr_comp;
+    }
+}
+
+NOINLINE static void proc_2(int32* int_ref) {
+    int32 int_loc = *int_ref + 10;
+    enumeration enum_loc = IDENT_2;
+    do {
+        if (ch_1_glob == 'A') {
+            int_loc -= 1;
+            *int_ref = int_loc - int_glob;
+            enum_loc = IDENT_1;
+        }
+    } while (enum_loc != IDENT_1);
+}
+
+NOINLINE static void proc_4() {
+    int32 bool_loc = ch_1_glob == 'A';
+    bool_glob = bool_loc | bool_glob;
+    ch_2_glob = 'B';
+}
+
+NOINLINE static void proc_5() {
+    ch_1_glob = 'A';
+    bool_glob = 0;
+}
+
+int main() {
+    int32 int_1_loc = 0, int_2_loc = 0, int_3_loc = 0;
+    enumeration enum_loc = IDENT_1;
+    str_30 str_1_loc, str_2_loc;
+
+    next_ptr_glob = &rec_a;
+    ptr_glob = &rec_b;
+    ptr_glob->ptr_comp = next_ptr_glob;
+    ptr_glob->discr = IDENT_1;
+    ptr_glob->variant.var_1.enum_comp = IDENT_3;
+    ptr_glob->variant.var_1.int_comp = 40;
+    strcpy(ptr_glob->variant.var_1.str_comp, "DHRYSTONE PROGRAM, SOME STRING");
+    strcpy(str_1_loc, "DHRYSTONE PROGRAM, 1'ST STRING");
+    arr_2_glob[8][7] = 10;
+
+    bench_start("dhrystone");
+
+    for (int32 run = 1; run <= RUNS; run++) {
+        proc_5();
+        proc_4();
+        int_1_loc = 2;
+        int_2_loc = 3;
+        strcpy(str_2_loc, "DHRYSTONE PROGRAM, 2'ND STRING");
+        enum_loc = IDENT_2;
+        bool_glob = !func_2(str_1_loc, str_2_loc);
+
+        while (int_1_loc < int_2_loc) {
+            int_3_loc = 5 * int_1_loc - int_2_loc;
+            proc_7(int_1_loc, int_2_loc, &int_3_loc);
+            int_1_loc += 1;
+        }
+
+        proc_8(arr_1_glob, arr_2_glob, int_1_loc, int_3_loc);
+        proc_1(ptr_glob);
+
+        for (char ch = 'A'; ch <= ch_2_glob; ch++) {
+            if (enum_loc == func_1(ch, 'C')) {
+                proc_6(IDENT_1, &enum_loc);
+                strcpy(str_2_loc, "DHRYSTONE PROGRAM, 3'RD STRING");
+                int_2_loc = run;
+                int_glob = run;
+            }
+        }
+
+        int_2_loc = int_2_loc * int_1_loc;
+        int_1_loc = int_2_loc / int_3_loc;
+        int_2_loc = 7 * (int_2_loc - int_3_loc) - int_1_loc;
+        proc_2(&int_1_loc);
+    }
+
+    bench_stop(RUNS, "dhrystones");
+
+    // Final values of the reference implementation
+    int err = 0;
+    err |= bench_check(int_glob, 5);
+    err |= bench_check(bool_glob, 1);
+    err |= bench_check(ch_1_glob, 'A');
+    err |= bench_check(ch_2_glob, 'B');
+    err |= bench_check(arr_1_glob[8], 7);
+    err |= bench_check(arr_2_glob[8][7], RUNS + 10);
+    err |= bench_check(ptr_glob->variant.var_1.int_comp, 17);
+    err |= bench_check(next_ptr_glob->variant.var_1.int_comp, 18);
+    err |= bench_check(next_ptr_glob->variant.var_1.enum_comp, IDENT_2);
+    err |= bench_check(int_1_loc, 5);
+    err |= bench_check(int_2_loc, 13);
+    err |= bench_check(int_3_loc, 7);
+    err |= bench_check(enum_loc, IDENT_2);
+    err |= bench_check(strcmp(str_2_loc, "DHRYSTONE PROGRAM, 2'ND STRING"), 0);
+
+    return err;
+}
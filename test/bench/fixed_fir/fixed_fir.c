@@ -0,0 +1,57 @@
+// Fixed point FIR filter, Q16 samples and coefficients with fixed.h MULFIX
+// 32 taps over a block of samples, the multiplies need the high word so
+// both mul and mulh are exercised. Score is output samples per Mcycle
+
+#include <riscv/types.h>
+#include <riscv/fixed.h>
+
+#include "../bench.h"
+
+#define SCALE 16
+#define TAPS 32
+#define SAMPLES 1024
+
+#define NOINLINE __attribute__((noinline))
+
+static int32 coefficients[TAPS];
+static int32 input[SAMPLES + TAPS];
+static int32 output[SAMPLES];
+
+NOINLINE static void fir(const int32* x, int32* y, uint32 n) {
+    for (uint32 i = 0; i < n; i++) {
+        int32 acc = 0;
+        for (uint32 t = 0; t < TAPS; t++) {
+            acc += MULFIX((int64) x[i + t], coefficients[t], SCALE);
+        }
+        y[i] = acc;
+    }
+}
+
+int main() {
+    // Triangular low pass window, sum 1.0
+    int32 sum = 0;
+    for (int32 t = 0; t < TAPS; t++) {
+        int32 w = t < TAPS / 2 ? t + 1 : TAPS - t;
+        coefficients[t] = w;
+        sum += w;
+    }
+    for (int32 t = 0; t < TAPS; t++) {
+        coefficients[t] = DIVFIX(coefficients[t], sum, SCALE);
+    }
+
+    // Square wave with noise, amplitude 100.0
+    uint32 seed = 12345;
+    for (int32 i = 0; i < SAMPLES + TAPS; i++) {
+        seed = seed * 1103515245 + 12345;
+        int32 noise = (int32) ((seed >> 16) & 0xffff) - 0x8000;
+        input[i] = ((i / 64) & 1 ? 100 : -100) * (1 << SCALE) + noise * 8;
+    }
+
+    bench_start("fixed_fir");
+    fir(input, output, SAMPLES);
+    bench_stop(SAMPLES, "samples");
+
+    uint32 checksum = 0;
+    for (int32 i = 0; i < SAMPLES; i++) checksum = checksum * 31 + (uint32) output[i];
+    return bench_check(checksum, 0xaf118119);
+}
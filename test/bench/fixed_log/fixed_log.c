@@ -0,0 +1,44 @@
+// Fixed point math, fixed.h log2fix and DIVFIX
+// Entropy style sum of p * log2(p) over a normalized histogram, Q14 so
+// the squaring steps of log2fix stay in 32 bits. Score is values per Mcycle
+
+#include <riscv/types.h>
+#include <riscv/fixed.h>
+
+#include "../bench.h"
+
+#define SCALE 14
+#define VALUES 512
+
+#define NOINLINE __attribute__((noinline))
+
+static int32 counts[VALUES];
+
+NOINLINE static int32 entropy(const int32* c, uint32 n, int32 total) {
+    int32 h = 0;
+    for (uint32 i = 0; i < n; i++) {
+        if (c[i] == 0) continue;
+        int32 p = DIVFIX(c[i], total, SCALE);
+        if (p == 0) continue;
+        h -= MULFIX((int64) p, log2fix(p, SCALE), SCALE);
+    }
+    return h;
+}
+
+int main() {
+    uint32 seed = 2024;
+    int32 total = 0;
+    for (int32 i = 0; i < VALUES; i++) {
+        seed = seed * 1103515245 + 12345;
+        counts[i] = (int32) ((seed >> 16) & 0x3ff) + 1;
+        total += counts[i];
+    }
+
+    bench_start("fixed_log");
+    // A few bins at a time, the histogram mass moves to the first ones
+    int32 h = 0;
+    for (int32 n = VALUES; n >= 8; n /= 2) h += entropy(counts, n, total);
+    bench_stop(2 * VALUES - 8, "values");
+
+    return bench_check((uint32) h, 0x43c83);
+}
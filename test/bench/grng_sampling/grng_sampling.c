@@ -0,0 +1,44 @@
+// GRNG sampling kernel
+// Draws samples from the custom gaussian generator and accumulates the
+// histogram, mean and variance like a Monte Carlo inner loop. Score is
+// samples per Mcycle
+
+#include <riscv/types.h>
+#include <riscv/custom.h>
+
+#include "../bench.h"
+
+#define SAMPLES 4096
+#define BINS 16
+#define SEED 0x5eed
+
+#define NOINLINE __attribute__((noinline))
+
+static uint32 histogram[BINS];
+
+NOINLINE static int64 sample(uint32 n, int64* sum_sq) {
+    int64 sum = 0, sq = 0;
+    for (uint32 i = 0; i < n; i++) {
+        int32 s = gen_num() >> 16;
+        histogram[(s >> 12) & (BINS - 1)]++;
+        sum += s;
+        sq += (int64) s * s;
+    }
+    *sum_sq = sq;
+    return sum;
+}
+
+int main() {
+    int64 sum_sq;
+
+    // Both operands, the seed register is the first one in the RTL
+    set_seed(SEED, SEED);
+
+    bench_start("grng_sampling");
+    int64 sum = sample(SAMPLES, &sum_sq);
+    bench_stop(SAMPLES, "samples");
+
+    uint32 checksum = (uint32) sum ^ (uint32) (sum_sq >> 8);
+    for (int32 i = 0; i < BINS; i++) checksum = checksum * 31 + histogram[i];
+    return bench_check(checksum, 0x9a5776c7);
+}
@@ -0,0 +1,154 @@
+# Runs the benchmark suite and reports cycles, IPC and scores
+# Every folder of test/bench is a benchmark built with compiler.sh, its
+# kernel is the profiler region BENCH_REGION (see bench.h). Results are
+# printed as a table and written as JSON
+# --compare takes the JSON of an earlier run, for example with another
+# RTL_CONFIG, and prints the kernel CPI change of every benchmark
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.realpath(__file__))
+ROOT_DIR = os.path.realpath(os.path.join(SCRIPT_DIR, "..", ".."))
+SIMULATOR = os.path.join(ROOT_DIR, "obj_dir", "Vrv32_top")
+COMPILER = os.path.join(ROOT_DIR, "compiler.sh")
+
+BENCH_REGION = 1
+# Dhrystones per second of the VAX 11/780, 1 DMIPS
+VAX_DHRYSTONES = 1757
+
+
+def benchmarks():
+    return sorted(
+        d for d in os.listdir(SCRIPT_DIR)
+        if os.path.isdir(os.path.join(SCRIPT_DIR, d)) and not d.startswith(".")
+    )
+
+
+def build(name, build_dir):
+    srcs = []
+    for root, _, files in os.walk(os.path.join(SCRIPT_DIR, name)):
+        srcs += [os.path.join(root, f) for f in files if f.endswith((".c", ".cpp", ".S"))]
+    r = subprocess.run(["bash", COMPILER, "-b", build_dir, *srcs],
+                       capture_output=True, text=True)
+    return r.returncode == 0, r.stdout + r.stderr
+
+
+def run(name, build_dir, simulator, sim_args):
+    stats_file = os.path.join(build_dir, "stats.json")
+    regions_file = os.path.join(build_dir, "regions.json")
+    r = subprocess.run(
+        [simulator, "+verilator+rand+reset+2", *sim_args,
+         "-e", os.path.join(build_dir, "main.elf"),
+         "-cj", stats_file, "-pj", regions_file],
+        capture_output=True, text=True)
+
+    result = {"name": name, "status": r.returncode}
+    m = re.search(r"^BENCH (\d+) (.+)$", r.stdout, re.MULTILINE)
+    if r.returncode != 0 or m is None:
+        result["output"] = r.stdout + r.stderr
+        return result
+
+    with open(stats_file) as f:
+        stats = json.load(f)
+    with open(regions_file) as f:
+        regions = {reg["id"]: reg for reg in json.load(f)["regions"]}
+
+    kernel = regions[BENCH_REGION]
+    units = int(m.group(1))
+
+    result.update({
+        "cycles": stats["cycles"],
+        "instructions": stats["instructions"],
+        "ipc": stats["ipc"],
+        "kernel_cycles": kernel["cycles"],
+        "kernel_instructions": kernel["instructions"],
+        "kernel_ipc": kernel["instructions"] / kernel["cycles"],
+        "units": units,
+        "unit": m.group(2),
+        # Work per million cycles, per MHz of clock
+        "score": units * 1e6 / kernel["cycles"],
+    })
+    if name == "dhrystone":
+        result["dmips_mhz"] = result["score"] / VAX_DHRYSTONES
+    return result
+
+
+def print_table(results):
+    print(f"\n{'Benchmark':<16}{'Cycles':>12}{'Instr':>12}{'IPC':>8}"
+          f"{'Kernel cyc':>12}{'K IPC':>8}  Score")
+    for r in results:
+        if r["status"] != 0 or "score" not in r:
+            print(f"{r['name']:<16}  FAIL {r['status']}")
+            continue
+        score = f"{r['score']:.2f} {r['unit']}/Mcycle"
+        if "dmips_mhz" in r:
+            score += f", {r['dmips_mhz']:.3f} DMIPS/MHz"
+        print(f"{r['name']:<16}{r['cycles']:>12}{r['instructions']:>12}{r['ipc']:>8.3f}"
+              f"{r['kernel_cycles']:>12}{r['kernel_ipc']:>8.3f}  {score}")
+    print("")
+
+
+def print_comparison(results, compare_file):
+    with open(compare_file) as f:
+        before = {r["name"]: r for r in json.load(f)["benchmarks"]}
+
+    print(f"Kernel CPI against {compare_file}")
+    print(f"{'Benchmark':<16}{'Before':>10}{'After':>10}{'Change':>10}{'Speedup':>10}")
+    for r in results:
+        b = before.get(r["name"])
+        if b is None or "score" not in b or "score" not in r:
+            continue
+        cpi_before = b["kernel_cycles"] / b["kernel_instructions"]
+        cpi_after = r["kernel_cycles"] / r["kernel_instructions"]
+        print(f"{r['name']:<16}{cpi_before:>10.3f}{cpi_after:>10.3f}"
+              f"{(cpi_after - cpi_before) * 100 / cpi_before:>+9.2f}%"
+              f"{b['kernel_cycles'] / r['kernel_cycles']:>9.3f}x")
+    print("")
+
+
+# usage run_bench.py [--json file] [--compare file] [--only name] [simulator args]
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--json", default=os.path.join(ROOT_DIR, "build", "bench", "results.json"))
+    parser.add_argument("--compare", help="results JSON of an earlier run")
+    parser.add_argument("--sim", default=SIMULATOR, help="verilated simulator")
+    parser.add_argument("--only", action="append", help="run only this benchmark")
+    parser.add_argument("sim_args", nargs="*", help="extra simulator arguments")
+    args = parser.parse_args()
+
+    if not os.path.exists(args.sim):
+        print(f"Simulator {args.sim} not built, run make first")
+        sys.exit(1)
+
+    results = []
+    for name in benchmarks():
+        if args.only and name not in args.only:
+            continue
+        build_dir = os.path.join(ROOT_DIR, "build", "bench", name)
+        ok, output = build(name, build_dir)
+        if not ok:
+            print(f"Error building {name}")
+            print(output)
+            results.append({"name": name, "status": "build"})
+            continue
+        results.append(run(name, build_dir, args.sim, args.sim_args))
+        if "output" in results[-1]:
+            print(f"{name} failed")
+            print(results[-1]["output"])
+
+    print_table(results)
+    if args.compare:
+        print_comparison(results, args.compare)
+
+    os.makedirs(os.path.dirname(args.json), exist_ok=True)
+    with open(args.json, "w") as f:
+        json.dump({"benchmarks": results}, f, indent=2)
+    print(f"Results written to {args.json}")
+
+    if any(r["status"] != 0 for r in results):
+        sys.exit(1)
@@ -0,0 +1,25 @@
+#include <riscv/profiler/external.h>
+
+// Regions are measured by the testbench, this only checks that every
+// profiler register is served (the program would hang otherwise)
+
+int fib(int n) {
+    start_external_region(300);
+    int r = n < 2 ? n : fib(n - 1) + fib(n - 2);
+    stop_external_region(300);
+    return r;
+}
+
+int main() {
+    set_external_region_name(300, "fib");
+    set_external_region_name(1000, "main");
+
+    start_external_region(1000);
+    start_external_counter(1);
+    int r = fib(8);
+    stop_external_counter(1);
+    stop_external_region(1000);
+
+    if (r != 21) return 1;
+    return 0;
+}
@@ -15,7 +15,8 @@ inline void exec_nops(const uint8 n) {
     exec_nops((nops));\
     stop_internal_counter(0);\
     cycles = get_internal_counter(0);\
-    if (cycles != (nops)) return (i);
+    if (cycles != (nops)) return (i);\
+    if (get_internal_counter_instret(0) != (nops)) return 10 + (i);
 
 
 int main() {
@@ -0,0 +1,253 @@
+# Performance regression gate
+# Builds and runs the ISA tests, C/C++ tests and benchmarks, collecting
+# total cycles, retired instructions and per profiler region calls, cycles
+# and instructions. The results are compared against the checked in
+# baseline.json, any metric above its baseline plus tolerance fails the
+# gate and the regressions are printed sorted by how much slower they got
+#
+# Tolerances are relative (0.02 is 2%). The top level "tolerance" applies
+# to every entry, an entry can override it with its own "tolerance", both
+# as a number or as an object per metric ({"cycles": 0.05})
+#
+# --update records the current results as the new baseline, keeping the
+# tolerances already in the file
+
+import argparse
+import concurrent.futures
+import glob
+import json
+import os
+import subprocess
+import sys
+
+SCRIPT_DIR = os.path.dirname(os.path.realpath(__file__))
+ROOT_DIR = os.path.realpath(os.path.join(SCRIPT_DIR, "..", ".."))
+TEST_DIR = os.path.join(ROOT_DIR, "test")
+SIMULATOR = os.path.join(ROOT_DIR, "obj_dir", "Vrv32_top")
+COMPILER = os.path.join(ROOT_DIR, "compiler.sh")
+BASELINE = os.path.join(SCRIPT_DIR, "baseline.json")
+BUILD_DIR = os.path.join(ROOT_DIR, "build", "perf")
+# Tolerance when the baseline sets none, absorbs small unrelated changes
+DEFAULT_TOLERANCE = 0.02
+
+METRICS = ["cycles", "instructions"]
+REGION_METRICS = ["calls", "cycles", "instructions"]
+
+RED = "\033[31m"
+GREEN = "\033[32m"
+BOLD = "\033[1m"
+NC = "\033[0m"
+
+
+# Programs to measure as (name, kind, source)
+def programs(extra):
+    progs = []
+    isa_dir = os.path.join(TEST_DIR, "isa_tests")
+    for pattern in ["base/base.S", "rv32ui/*.S", "rv32zicsr/*.S", "rv32mul/*.S", "rv32div/*.S"]:
+        for src in sorted(glob.glob(os.path.join(isa_dir, pattern))):
+            rel = os.path.relpath(src, isa_dir)
+            progs.append((f"isa/{os.path.splitext(rel)[0]}", "isa", rel))
+
+    folders = ["c_tests", "cpp_tests", "bench"] + (["extra"] if extra else [])
+    for folder in folders:
+        path = os.path.join(TEST_DIR, folder)
+        for name in sorted(os.listdir(path)):
+            if os.path.isdir(os.path.join(path, name)):
+                progs.append((f"{folder}/{name}", "c", os.path.join(path, name)))
+    return progs
+
+
+def build(name, kind, src):
+    if kind == "isa":
+        r = subprocess.run(
+            ["make", "-C", os.path.join(TEST_DIR, "isa_tests"), f"TEST_TARGET={src}"],
+            capture_output=True, text=True)
+        elf = os.path.join(ROOT_DIR, "build", "isa_tests", os.path.splitext(src)[0] + ".elf")
+        return r.returncode == 0, elf, r.stdout + r.stderr
+
+    srcs = []
+    for root, _, files in os.walk(src):
+        srcs += [os.path.join(root, f) for f in files if f.endswith((".c", ".cpp", ".S"))]
+    build_dir = os.path.join(BUILD_DIR, name)
+    r = subprocess.run(["bash", COMPILER, "-b", build_dir, *srcs],
+                       capture_output=True, text=True)
+    return r.returncode == 0, os.path.join(build_dir, "main.elf"), r.stdout + r.stderr
+
+
+def measure(prog, timeout):
+    name, kind, src = prog
+    ok, elf, output = build(name, kind, src)
+    if not ok:
+        return name, None, f"build failed\n{output}"
+
+    out_dir = os.path.join(BUILD_DIR, name)
+    os.makedirs(out_dir, exist_ok=True)
+    stats_file = os.path.join(out_dir, "stats.json")
+    regions_file = os.path.join(out_dir, "regions.json")
+    try:
+        r = subprocess.run(
+            [SIMULATOR, "+verilator+rand+reset+2", "-e", elf,
+             "-cj", stats_file, "-pj", regions_file],
+            capture_output=True, text=True, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return name, None, "timeout"
+    if r.returncode != 0:
+        return name, None, f"exit {r.returncode}\n{r.stdout}{r.stderr}"
+
+    with open(stats_file) as f:
+        stats = json.load(f)
+    result = {m: stats[m] for m in METRICS}
+
+    regions = {}
+    if os.path.exists(regions_file):
+        with open(regions_file) as f:
+            for reg in json.load(f)["regions"]:
+                key = reg["name"] if reg["name"] else str(reg["id"])
+                regions[key] = {m: reg[m] for m in REGION_METRICS}
+    if regions:
+        result["regions"] = regions
+    return name, result, ""
+
+
+def tolerance(baseline, entry, metric):
+    default = baseline.get("tolerance", DEFAULT_TOLERANCE)
+    tol = entry.get("tolerance", default)
+    if isinstance(tol, dict):
+        return tol.get(metric, default)
+    return tol
+
+
+# Flat list of (name, metric, baseline value, current value, tolerance)
+def compare(baseline, results):
+    rows = []
+    for name, cur in results.items():
+        entry = baseline["entries"].get(name)
+        if entry is None:
+            continue
+        for m in METRICS:
+            rows.append((name, m, entry[m], cur[m], tolerance(baseline, entry, m)))
+        for reg, base_reg in entry.get("regions", {}).items():
+            cur_reg = cur.get("regions", {}).get(reg)
+            for m in REGION_METRICS:
+                metric = f"{reg}.{m}"
+                value = cur_reg[m] if cur_reg is not None else None
+                rows.append((name, metric, base_reg[m], value, tolerance(baseline, entry, m)))
+    return rows
+
+
+def pct(base, value):
+    if base == 0:
+        return float("inf") if value else 0.0
+    return (value - base) * 100.0 / base
+
+
+def print_diff(title, rows, color):
+    print(f"\n{color}{BOLD}{title}{NC}")
+    print(f"  {'Program':<32}{'Metric':<28}{'Baseline':>12}{'Current':>12}{'Delta':>10}{'Tol':>8}")
+    for name, metric, base, value, tol in rows:
+        if value is None:
+            print(f"  {name:<32}{metric:<28}{base:>12}{'missing':>12}")
+            continue
+        print(f"  {name:<32}{metric:<28}{base:>12}{value:>12}"
+              f"{pct(base, value):>+9.2f}%{tol * 100:>7.1f}%")
+
+
+def update_baseline(baseline, results):
+    entries = {}
+    for name, cur in sorted(results.items()):
+        entry = dict(cur)
+        old = baseline["entries"].get(name, {})
+        if "tolerance" in old:
+            entry["tolerance"] = old["tolerance"]
+        entries[name] = entry
+    baseline["entries"] = entries
+    with open(BASELINE, "w") as f:
+        json.dump(baseline, f, indent=2)
+        f.write("\n")
+    print(f"Baseline with {len(entries)} programs written to {BASELINE}")
+
+
+# usage perf_gate.py [--update] [--extra] [--allow-new] [-j jobs]
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--update", action="store_true", help="record the results as baseline")
+    parser.add_argument("--extra", action="store_true", help="also measure test/extra")
+    parser.add_argument("--allow-new", action="store_true",
+                        help="only report programs missing from the baseline")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--timeout", type=float, default=600)
+    args = parser.parse_args()
+
+    if not os.path.exists(SIMULATOR):
+        print(f"Simulator {SIMULATOR} not built, run make first")
+        sys.exit(1)
+
+    with open(BASELINE) as f:
+        baseline = json.load(f)
+
+    # ISA tests share one Makefile and build dir, build them serially
+    progs = programs(args.extra)
+    results = {}
+    errors = []
+    with concurrent.futures.ProcessPoolExecutor(max_workers=args.jobs) as pool:
+        isa = [p for p in progs if p[1] == "isa"]
+        jobs = [pool.submit(measure, p, args.timeout) for p in progs if p[1] != "isa"]
+        for p in isa:
+            name, result, error = measure(p, args.timeout)
+            if result is None:
+                errors.append((name, error))
+            else:
+                results[name] = result
+        for job in concurrent.futures.as_completed(jobs):
+            name, result, error = job.result()
+            if result is None:
+                errors.append((name, error))
+            else:
+                results[name] = result
+
+    for name, error in sorted(errors):
+        print(f"{RED}{name} failed: {error}{NC}")
+    if errors:
+        print(f"{RED}{BOLD}{len(errors)} programs failed, no performance comparison{NC}")
+        sys.exit(1)
+
+    if args.update:
+        update_baseline(baseline, results)
+        sys.exit(0)
+
+    rows = compare(baseline, results)
+    regressions = [r for r in rows if r[3] is None or r[3] > r[2] * (1 + r[4])]
+    improvements = [r for r in rows if r[3] is not None and r[3] < r[2] * (1 - r[4])]
+    new = sorted(set(results) - set(baseline["entries"]))
+    gone = sorted(set(baseline["entries"]) - set(results))
+
+    # Most slowed down first, missing regions on top
+    regressions.sort(key=lambda r: float("inf") if r[3] is None else pct(r[2], r[3]),
+                     reverse=True)
+    improvements.sort(key=lambda r: pct(r[2], r[3]))
+
+    if improvements:
+        print_diff(f"{len(improvements)} METRICS IMPROVED (run make perf-update to record)",
+                   improvements, GREEN)
+    # An empty or stale baseline must not pass silently
+    if new:
+        color = NC if args.allow_new else RED
+        print(f"\n{color}Not in baseline (run make perf-update to record): {', '.join(new)}{NC}")
+    if gone:
+        print(f"\nIn baseline but not measured: {', '.join(gone)}")
+
+    failed = bool(regressions) or (not args.allow_new and bool(new))
+    if regressions:
+        print_diff(f"{len(regressions)} METRICS REGRESSED", regressions, RED)
+
+    print("")
+    if failed:
+        print(f"{RED}{BOLD}PERFORMANCE GATE FAILED{NC}")
+        if regressions:
+            slower = sorted({r[0] for r in regressions})
+            print(f"{RED}Slower programs: {', '.join(slower)}{NC}")
+        if new and not args.allow_new:
+            print(f"{RED}{len(new)} programs without baseline{NC}")
+        sys.exit(1)
+    print(f"{GREEN}{BOLD}PERFORMANCE GATE PASSED{NC} "
+          f"({len(results) - len(new)} programs, {len(rows)} metrics checked)")
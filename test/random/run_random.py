@@ -0,0 +1,106 @@
+# Parallel differential runs of random programs
+# Each program is generated, built with the isa_tests environment and run
+# in the harness in lockstep with the ISS (-ls). Programs that fail to
+# build, mismatch or time out are kept with their output in the failure
+# directory, the rest are deleted
+
+import argparse
+import concurrent.futures
+import os
+import shutil
+import subprocess
+import sys
+import time
+
+import rvgen
+
+SCRIPT_DIR = os.path.dirname(os.path.realpath(__file__))
+ROOT_DIR = os.path.realpath(os.path.join(SCRIPT_DIR, "..", ".."))
+SIMULATOR = os.path.join(ROOT_DIR, "obj_dir", "Vrv32_top")
+
+CC = "riscv64-unknown-elf-gcc"
+CFLAGS = [
+    "-march=rv32im_zicsr", "-mabi=ilp32",
+    "-I", os.path.join(ROOT_DIR, "test", "isa_tests", "macros"),
+    "-I", os.path.join(ROOT_DIR, "bsp", "include"),
+    "-ffreestanding", "-nostartfiles", "-nostdlib",
+    "-T", os.path.join(ROOT_DIR, "test", "isa_tests", "linker.lds"),
+]
+
+
+def run_one(seed, length, build_dir, timeout):
+    work = os.path.join(build_dir, str(seed))
+    os.makedirs(work, exist_ok=True)
+    src = os.path.join(work, "prog.S")
+    elf = os.path.join(work, "prog.elf")
+
+    with open(src, "w") as f:
+        f.write(rvgen.generate(seed, length))
+
+    r = subprocess.run([CC, *CFLAGS, src, "-o", elf], capture_output=True, text=True)
+    if r.returncode != 0:
+        return seed, "build", r.stderr
+
+    try:
+        r = subprocess.run(
+            [SIMULATOR, "+verilator+rand+reset+2", "-ls", "-e", elf],
+            capture_output=True, text=True, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return seed, "timeout", ""
+
+    if r.returncode != 0:
+        return seed, f"exit {r.returncode}", r.stdout + r.stderr
+
+    shutil.rmtree(work)
+    return seed, "pass", ""
+
+
+# usage run_random.py -n programs -j jobs --seed first --length L
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-n", "--programs", type=int, default=1000)
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    parser.add_argument("--seed", type=int, default=0, help="seed of the first program")
+    parser.add_argument("--length", type=int, default=500, help="lines per program")
+    parser.add_argument("--timeout", type=float, default=60)
+    parser.add_argument("--build", default=os.path.join(ROOT_DIR, "build", "random"))
+    args = parser.parse_args()
+
+    if not os.path.exists(SIMULATOR):
+        print(f"Simulator {SIMULATOR} not built, run make first")
+        sys.exit(1)
+
+    fail_dir = os.path.join(args.build, "fail")
+    os.makedirs(fail_dir, exist_ok=True)
+
+    start = time.time()
+    failures = []
+    done = 0
+
+    with concurrent.futures.ProcessPoolExecutor(max_workers=args.jobs) as pool:
+        jobs = [
+            pool.submit(run_one, seed, args.length, args.build, args.timeout)
+            for seed in range(args.seed, args.seed + args.programs)
+        ]
+        for job in concurrent.futures.as_completed(jobs):
+            seed, status, output = job.result()
+            done += 1
+            if status != "pass":
+                failures.append((seed, status))
+                kept = os.path.join(fail_dir, str(seed))
+                shutil.rmtree(kept, ignore_errors=True)
+                shutil.move(os.path.join(args.build, str(seed)), kept)
+                with open(os.path.join(kept, "output.txt"), "w") as f:
+                    f.write(output)
+                print(f"FAIL seed {seed}: {status}")
+            if done % 100 == 0:
+                print(f"{done}/{args.programs} programs")
+
+    elapsed = time.time() - start
+    print(f"\n{done - len(failures)}/{done} passed in {elapsed:.1f}s, "
+          f"{done / elapsed * 60:.0f} programs/min on {args.jobs} jobs")
+    if failures:
+        print(f"Failing programs kept in {fail_dir}")
+        for seed, status in sorted(failures):
+            print(f"  seed {seed}: {status}")
+        sys.exit(1)
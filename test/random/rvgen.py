@@ -0,0 +1,291 @@
+# Constrained random program generator
+# RV32IM, Zicsr and GRNG instruction streams biased towards the
+# pipeline hazards of the core: bypass chains, load-use, back to back CSR
+# accesses and branches on loaded values
+# Programs use the isa_tests environment and pass with exit status 0, the
+# checking is done by running them in lockstep with the ISS (-ls)
+
+import argparse
+import random
+
+# Registers never written, x8 holds the data buffer address
+BASE_REG = 8
+WRITABLE = [r for r in range(32) if r != BASE_REG]
+BUFFER_BYTES = 256
+
+ALU_RR = ["add", "sub", "sll", "slt", "sltu", "xor", "srl", "sra", "or", "and"]
+ALU_RI = ["addi", "slti", "sltiu", "xori", "ori", "andi"]
+SHIFT_RI = ["slli", "srli", "srai"]
+MUL = ["mul", "mulh", "mulhsu", "mulhu"]
+DIV = ["div", "divu", "rem", "remu"]
+BRANCH = ["beq", "bne", "blt", "bge", "bltu", "bgeu"]
+LOADS = [("lb", 1), ("lbu", 1), ("lh", 2), ("lhu", 2), ("lw", 4)]
+STORES = [("sb", 1), ("sh", 2), ("sw", 4)]
+CSR_RR = ["csrrw", "csrrs", "csrrc"]
+CSR_RI = ["csrrwi", "csrrsi", "csrrci"]
+
+
+class Generator:
+
+    def __init__(self, seed):
+        self.rnd = random.Random(seed)
+        self.labels = 0
+        self.lines = []
+
+    # Helpers
+
+    def x(self, r):
+        return f"x{r}"
+
+    def rd(self):
+        # x0 destinations check that x0 is never bypassed
+        if self.rnd.random() < 0.05:
+            return 0
+        return self.rnd.choice(WRITABLE)
+
+    def rs(self):
+        return self.rnd.randrange(32)
+
+    def imm12(self):
+        return self.rnd.choice([0, 1, -1, 2047, -2048, self.rnd.randrange(-2048, 2048)])
+
+    def label(self):
+        self.labels += 1
+        return f"L{self.labels}"
+
+    def emit(self, s):
+        self.lines.append("    " + s)
+
+    def emit_label(self, l):
+        self.lines.append(f"{l}:")
+
+    def offset(self, size):
+        return self.rnd.randrange(0, BUFFER_BYTES, size)
+
+    # Single instructions
+
+    def alu(self, rd, a, b=None):
+        if b is None:
+            b = self.rs()
+        kind = self.rnd.random()
+        if kind < 0.5:
+            self.emit(f"{self.rnd.choice(ALU_RR)} {self.x(rd)}, {self.x(a)}, {self.x(b)}")
+        elif kind < 0.8:
+            self.emit(f"{self.rnd.choice(ALU_RI)} {self.x(rd)}, {self.x(a)}, {self.imm12()}")
+        else:
+            self.emit(f"{self.rnd.choice(SHIFT_RI)} {self.x(rd)}, {self.x(a)}, {self.rnd.randrange(32)}")
+
+    def mul(self, rd, a, b):
+        self.emit(f"{self.rnd.choice(MUL)} {self.x(rd)}, {self.x(a)}, {self.x(b)}")
+
+    def div(self, rd, a, b):
+        self.emit(f"{self.rnd.choice(DIV)} {self.x(rd)}, {self.x(a)}, {self.x(b)}")
+
+    def load(self, rd):
+        op, size = self.rnd.choice(LOADS)
+        self.emit(f"{op} {self.x(rd)}, {self.offset(size)}({self.x(BASE_REG)})")
+
+    def store(self, src):
+        op, size = self.rnd.choice(STORES)
+        self.emit(f"{op} {self.x(src)}, {self.offset(size)}({self.x(BASE_REG)})")
+
+    def genum(self, rd):
+        self.emit(f".insn r 0x0b, 1, 0, {self.x(rd)}, x0, x0")
+
+    def consumer(self, src):
+        # Any instruction reading src
+        other = self.rs()
+        a, b = (src, other) if self.rnd.random() < 0.5 else (other, src)
+        kind = self.rnd.randrange(5)
+        if kind == 0:
+            self.alu(self.rd(), a, b)
+        elif kind == 1:
+            self.mul(self.rd(), a, b)
+        elif kind == 2:
+            self.store(src)
+        elif kind == 3:
+            self.emit(f"csrrw {self.x(self.rd())}, mscratch, {self.x(src)}")
+        else:
+            self.skip_branch(a, b)
+
+    def filler(self, n):
+        for _ in range(n):
+            self.alu(self.rd(), self.rs())
+
+    def skip_branch(self, a, b):
+        # Forward only, programs always end
+        l = self.label()
+        self.emit(f"{self.rnd.choice(BRANCH)} {self.x(a)}, {self.x(b)}, {l}")
+        self.filler(self.rnd.randrange(1, 4))
+        self.emit_label(l)
+
+    # Hazard sequences
+
+    def seq_bypass_chain(self):
+        # Producer/consumer at distance 1 to 3, exec and mem bypass
+        src = self.rd()
+        self.alu(src, self.rs())
+        for _ in range(self.rnd.randrange(2, 5)):
+            self.filler(self.rnd.randrange(0, 3))
+            dst = self.rd()
+            if self.rnd.random() < 0.3:
+                self.mul(dst, src, self.rs())
+            else:
+                self.alu(dst, src)
+            src = dst
+
+    def seq_load_use(self):
+        rd = self.rd()
+        self.load(rd)
+        self.filler(self.rnd.choice([0, 0, 1]))
+        self.consumer(rd)
+
+    def seq_store_load(self):
+        op, size = self.rnd.choice(STORES)
+        off = self.offset(size)
+        self.emit(f"{op} {self.x(self.rs())}, {off}({self.x(BASE_REG)})")
+        lop = self.rnd.choice([l for l, s in LOADS if s <= size])
+        rd = self.rd()
+        self.emit(f"{lop} {self.x(rd)}, {off}({self.x(BASE_REG)})")
+        self.consumer(rd)
+
+    def seq_csr_back_to_back(self):
+        src = self.rs()
+        for _ in range(self.rnd.randrange(2, 5)):
+            rd = self.rd()
+            if self.rnd.random() < 0.7:
+                self.emit(f"{self.rnd.choice(CSR_RR)} {self.x(rd)}, mscratch, {self.x(src)}")
+            else:
+                self.emit(f"{self.rnd.choice(CSR_RI)} {self.x(rd)}, mscratch, {self.rnd.randrange(32)}")
+            src = rd
+        if self.rnd.random() < 0.2:
+            # Counters follow the RTL value in lockstep
+            rd = self.rd()
+            self.emit(f"csrr {self.x(rd)}, {self.rnd.choice(['mcycle', 'minstret', 'mcountinhibit'])}")
+        self.consumer(src)
+
+    def seq_branch_after_load(self):
+        rd = self.rd()
+        self.load(rd)
+        other = self.rs()
+        a, b = (rd, other) if self.rnd.random() < 0.5 else (other, rd)
+        self.skip_branch(a, b)
+
+    def seq_mul_chain(self):
+        src = self.rd()
+        self.mul(src, self.rs(), self.rs())
+        for _ in range(self.rnd.randrange(1, 4)):
+            dst = self.rd()
+            self.mul(dst, src, self.rs())
+            src = dst
+        self.consumer(src)
+
+    def seq_div(self):
+        # Divisor 0, -1, small or any, the dividend chained from the
+        # previous result to hit the early-out and the longest divisions
+        divisor = self.rd()
+        value = self.rnd.choice([0, -1, 1, self.rnd.randrange(2, 16), None])
+        if value is None:
+            self.alu(divisor, self.rs())
+        else:
+            self.emit(f"li {self.x(divisor)}, {value}")
+        src = self.rs()
+        for _ in range(self.rnd.randrange(1, 3)):
+            dst = self.rd()
+            self.div(dst, src, divisor)
+            src = dst
+        self.consumer(src)
+
+    def seq_grng(self):
+        if self.rnd.random() < 0.2:
+            # Generator warm up after set seed
+            self.emit(f".insn r 0x0b, 0, 0, x0, {self.x(self.rs())}, x0")
+            for _ in range(4):
+                self.emit("nop")
+        for _ in range(self.rnd.randrange(1, 4)):
+            rd = self.rd()
+            self.genum(rd)
+            self.consumer(rd)
+
+    def seq_jump(self):
+        l = self.label()
+        rd = self.rd()
+        if self.rnd.random() < 0.5:
+            self.emit(f"jal {self.x(rd)}, {l}")
+        else:
+            tmp = self.rd() or 1
+            self.emit(f"la {self.x(tmp)}, {l}")
+            self.emit(f"jalr {self.x(rd)}, 0({self.x(tmp)})")
+        self.filler(self.rnd.randrange(1, 3))
+        self.emit_label(l)
+        # Link register consumer
+        self.consumer(rd)
+
+    def seq_upper(self):
+        op = self.rnd.choice(["lui", "auipc"])
+        rd = self.rd()
+        self.emit(f"{op} {self.x(rd)}, {self.rnd.randrange(1 << 20)}")
+        self.consumer(rd)
+
+    SEQUENCES = [
+        (seq_bypass_chain, 5),
+        (seq_load_use, 5),
+        (seq_store_load, 3),
+        (seq_csr_back_to_back, 3),
+        (seq_branch_after_load, 4),
+        (seq_mul_chain, 2),
+        (seq_div, 2),
+        (seq_grng, 2),
+        (seq_jump, 2),
+        (seq_upper, 1),
+    ]
+
+    def program(self, length):
+        seqs, weights = zip(*self.SEQUENCES)
+        self.lines = []
+
+        self.emit(f"la {self.x(BASE_REG)}, buffer")
+        for r in WRITABLE[1:]:
+            self.emit(f"li {self.x(r)}, {self.rnd.randrange(1 << 32):#x}")
+
+        while len(self.lines) < length:
+            self.rnd.choices(seqs, weights)[0](self)
+
+        body = "\n".join(self.lines)
+        data = "\n".join(f"    .word {self.rnd.randrange(1 << 32):#010x}"
+                         for _ in range(BUFFER_BYTES // 4))
+
+        return f"""# Random program, generated by rvgen.py
+
+#include <riscv_test.h>
+
+RVTEST_CODE_BEGIN
+
+{body}
+
+    RVTEST_PASS
+
+RVTEST_DATA_BEGIN
+buffer:
+{data}
+"""
+
+
+def generate(seed, length):
+    return Generator(seed).program(length)
+
+
+# usage rvgen.py --seed N --length L -o file.S
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--length", type=int, default=500)
+    parser.add_argument("-o", "--output", default="-")
+    args = parser.parse_args()
+
+    program = generate(args.seed, args.length)
+    if args.output == "-":
+        print(program)
+    else:
+        with open(args.output, "w") as f:
+            f.write(program)
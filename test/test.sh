@@ -6,13 +6,28 @@ NC='\e[0m'
 BOLD='\e[1m'
 UNDERLINE='\e[4m'
 
+# Options
+# --extra also runs the extra tests
+# --lockstep runs every test in lockstep with the ISS
+run_extra=0
+sim_args=""
+for arg in "$@"; do
+    case $arg in
+        --extra) run_extra=1 ;;
+        --lockstep) sim_args="-ls" ;;
+    esac
+done
+
 # Functions
 
 # Vars/Parameters of the function
 num_tests=0
 num_pass=0
 num_fail=0
+# Failures of all sections, exit status of the script
+total_fail=0
 print_test_results() {
+    total_fail=$((total_fail+num_fail))
     echo " "
     echo -e "${UNDERLINE}RESULTS${NC}"
     if [ $num_fail -ne 0 ]; then
@@ -63,7 +78,7 @@ run_all_folder_tests() {
             echo -e "$build_output"
             num_fail=$((num_fail+1))
         else
-            test_res=$(../obj_dir/Vrv32_top +verilator+rand+reset+2\
+            test_res=$(../obj_dir/Vrv32_top +verilator+rand+reset+2 $sim_args\
                         -e ../build/$test_folder/$test/main.elf 2>&1)
             test_status=$?
 
@@ -79,7 +94,7 @@ run_all_folder_tests() {
 # ISA TEST SECTION
 
 cd isa_tests
-rv_tests="$(ls base/base.S rv32ui/*.S rv32zicsr/*.S rv32mul/*.S)"
+rv_tests="$(ls base/base.S rv32ui/*.S rv32zicsr/*.S rv32mul/*.S rv32div/*.S)"
 cd ..
 
 i=1
@@ -104,7 +119,7 @@ do
         num_fail=$((num_fail+1))
     else
         # Run simulation
-        test_result=$(../obj_dir/Vrv32_top +verilator+rand+reset+2\
+        test_result=$(../obj_dir/Vrv32_top +verilator+rand+reset+2 $sim_args\
                     -e ../build/isa_tests/${test%.S}.elf 2>&1)
         test_status=$?
         check_test
@@ -123,8 +138,12 @@ run_all_folder_tests
 test_folder="cpp_tests"
 run_all_folder_tests
 
-if [ "$1" == "--extra" ]; then
+if [ $run_extra -eq 1 ]; then
     # EXTRA TEST SECTION
     test_folder="extra"
     run_all_folder_tests
 fi
+
+if [ $total_fail -ne 0 ]; then
+    exit 1
+fi
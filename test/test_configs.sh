@@ -0,0 +1,54 @@
+# Runs the tests and the random programs in lockstep with the ISS for every
+# core configuration below, the default one is covered by make test
+
+RED='\e[31m'
+GREEN='\e[32m'
+NC='\e[0m'
+BOLD='\e[1m'
+
+# Options
+# -n programs, random programs per configuration (default 200)
+programs=200
+while [ $# -gt 0 ]; do
+    case $1 in
+        -n) programs=$2; shift ;;
+    esac
+    shift
+done
+
+# RTL_CONFIG of each configuration, one per line
+configs=(
+    "-DRV32_BRANCH_PREDICTOR=1"
+    "-DRV32_BRANCH_PREDICTOR=2"
+    "-DRV32_EARLY_JUMP=1"
+    "-DRV32_EARLY_JUMP=2"
+    "-DRV32_ICACHE=1"
+    "-DRV32_DCACHE=1"
+    "-DRV32_STORE_BUFFER=4"
+    "-DRV32_FETCH_QUEUE=4"
+    "-DRV32_MUL_STAGES=2"
+    "-DRV32_MUL_STAGES=3"
+)
+
+failed=()
+for config in "${configs[@]}"; do
+    echo " "
+    echo -e "${BOLD}CONFIGURATION $config${NC}"
+
+    status=0
+    make RTL_CONFIG="$config" test TEST_ARGS="--lockstep" || status=1
+    make RTL_CONFIG="$config" random RANDOM_ARGS="-n $programs" || status=1
+
+    if [ $status -ne 0 ]; then
+        failed+=("$config")
+    fi
+done
+
+echo " "
+if [ ${#failed[@]} -ne 0 ]; then
+    for config in "${failed[@]}"; do
+        echo -e "${RED}FAILED $config${NC}"
+    done
+    exit 1
+fi
+echo -e "${GREEN}ALL ${#configs[@]} CONFIGURATIONS PASSED${NC}"
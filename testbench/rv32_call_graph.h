@@ -0,0 +1,204 @@
+#ifndef RV32_CALL_GRAPH
+#define RV32_CALL_GRAPH
+
+#include <algorithm>
+#include <iostream>
+#include <format>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_elf_symbols.h"
+
+namespace rv32_test {
+
+// Call graph profiler
+// Rebuilds a shadow call stack from the retired instructions following the
+// standard link register convention (x1/x5) and attributes every cycle to
+// the current call path
+// - JAL/JALR rd = link: call
+// - JALR rs1 = link, rd = x0: return
+// - JAL rd = x0 to the start of another function: tail call
+// - Retire of __trap_handler not caused by a jump: trap entry, mret returns
+
+constexpr uint32_t MRET_INSTR = 0x30200073;
+const std::string TRAP_HANDLER_SYMBOL = "__trap_handler";
+
+struct CallNode {
+    std::string name;
+    CallNode* parent = nullptr;
+    std::map<std::string, std::unique_ptr<CallNode>> children;
+    uint64_t exclusive = 0;
+    uint64_t calls = 0;
+    bool trap = false;
+
+    CallNode* child(const std::string& child_name) {
+        auto& c = children[child_name];
+        if (!c) {
+            c = std::make_unique<CallNode>();
+            c->name = child_name;
+            c->parent = this;
+        }
+        return c.get();
+    }
+
+    uint64_t inclusive() const {
+        uint64_t n = exclusive;
+        for (auto& [_, c] : children) n += c->inclusive();
+        return n;
+    }
+};
+
+enum class PendingJump { NONE, CALL, TAIL, JUMP };
+
+class CallGraphProfiler {
+  public:
+    bool enabled = false;
+    std::string output = "";
+    const SymbolTable* symbols = nullptr;
+
+    CallNode root;
+    CallNode* current = nullptr;
+    PendingJump pending = PendingJump::NONE;
+    uint32_t trap_addr = 0;
+    bool has_trap_addr = false;
+    uint64_t total_cycles = 0;
+
+    void init(const std::string out, const SymbolTable* table) {
+        enabled = true;
+        output = out;
+        symbols = table;
+        root.name = "[root]";
+        has_trap_addr = symbols->address(TRAP_HANDLER_SYMBOL, trap_addr);
+    }
+
+    static bool is_link(uint32_t r) { return r == 1 || r == 5; }
+
+    // Updates the stack with the pc of a new retired instruction
+    void enter(uint32_t pc) {
+        const ElfSymbol* s = symbols->find(pc);
+        std::string name = s == nullptr ? "???" : s->name;
+
+        // First instruction
+        if (current == nullptr) {
+            current = root.child(name);
+            current->calls++;
+        }
+        else if (pending == PendingJump::CALL) {
+            current = current->child(name);
+            current->calls++;
+        }
+        else if (pending == PendingJump::TAIL &&
+            s != nullptr && s->addr == pc && name != current->name) {
+            CallNode* parent = current->parent;
+            current = parent->child(name);
+            current->calls++;
+        }
+        else if (pending == PendingJump::NONE &&
+            has_trap_addr && pc == trap_addr) {
+            current = current->child(name);
+            current->trap = true;
+            current->calls++;
+        }
+
+        pending = PendingJump::NONE;
+    }
+
+    void leave(bool trap) {
+        CallNode* n = current;
+        // mret unwinds up to the trap frame
+        if (trap) {
+            while (n->parent != &root && !n->trap) n = n->parent;
+        }
+        // Unbalanced returns do not leave the first frame
+        if (n->parent != &root) current = n->parent;
+    }
+
+    void cycle(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+        if (!enabled) return;
+
+        WritebackStageData wbd;
+        if (rm.retired) {
+            wbd = get_wb_stage_data(rvtop);
+            enter(wbd.pc);
+        }
+
+        if (current == nullptr) return;
+        current->exclusive++;
+        total_cycles++;
+
+        if (!rm.retired) return;
+
+        // Effect of the retired instruction on the stack
+        Instruction instr = wbd.instr;
+        if (instr.get() == MRET_INSTR) {
+            leave(true);
+        }
+        else if (instr.opcode == RV32Types::OPCODE_JAL) {
+            if (is_link(instr.rd)) pending = PendingJump::CALL;
+            else if (instr.rd == 0) pending = PendingJump::TAIL;
+            else pending = PendingJump::JUMP;
+        }
+        else if (instr.opcode == RV32Types::OPCODE_JALR) {
+            if (is_link(instr.rd)) pending = PendingJump::CALL;
+            else if (instr.rd == 0 && is_link(instr.rs1)) leave(false);
+            else pending = PendingJump::JUMP;
+        }
+    }
+
+    void write_node_text(std::ofstream& f, const CallNode* n, uint32_t depth) const {
+        std::vector<const CallNode*> sorted;
+        for (auto& [_, c] : n->children) sorted.push_back(c.get());
+        std::sort(sorted.begin(), sorted.end(),
+            [](const CallNode* a, const CallNode* b) {
+                return a->inclusive() > b->inclusive();
+            });
+
+        for (const CallNode* c : sorted) {
+            uint64_t inc = c->inclusive();
+            f << std::format("{:>14} {:>7.2f} {:>14} {:>7.2f} {:>10}  {}{}{}\n",
+                inc, 100.0 * inc / total_cycles,
+                c->exclusive, 100.0 * c->exclusive / total_cycles,
+                c->calls, std::string(2 * depth, ' '), c->name,
+                c->trap ? " [trap]" : "");
+            write_node_text(f, c, depth + 1);
+        }
+    }
+
+    void write_node_folded(std::ofstream& f, const CallNode* n, const std::string& path) const {
+        for (auto& [_, c] : n->children) {
+            std::string p = path == "" ? c->name : path + ";" + c->name;
+            if (c->exclusive) f << p << ' ' << c->exclusive << '\n';
+            write_node_folded(f, c.get(), p);
+        }
+    }
+
+    // output.txt call tree with inclusive/exclusive cycles
+    // output.folded one line per call path for flame graph tools
+    void write() const {
+        if (!enabled || total_cycles == 0) return;
+
+        std::ofstream f(output + ".txt");
+        std::ofstream ff(output + ".folded");
+        if (!f.is_open() || !ff.is_open()) {
+            std::cerr << "Cannot open call graph output " << output << '\n';
+            return;
+        }
+
+        f << std::format("Call graph, {} cycles\n\n", total_cycles);
+        f << std::format("{:>14} {:>7} {:>14} {:>7} {:>10}  {}\n",
+            "inclusive", "%", "exclusive", "%", "calls", "function");
+        write_node_text(f, &root, 0);
+
+        write_node_folded(ff, &root, "");
+
+        std::cout << "Call graph written to " << output << ".txt\n";
+    }
+};
+
+static CallGraphProfiler call_graph;
+
+}
+
+#endif
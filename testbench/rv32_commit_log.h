@@ -0,0 +1,121 @@
+#ifndef RV32_COMMIT_LOG
+#define RV32_COMMIT_LOG
+
+#include <cstdio>
+#include <iostream>
+#include <format>
+#include <iterator>
+#include <unordered_map>
+
+#include "rv32_test_utils.h"
+
+namespace rv32_test {
+
+// Commit log in the format of spike --log-commits, 1 line per retired
+// instruction with its register write, CSR write and memory access
+//   core   0: 3 0x00000010 (0x00b52023) mem 0x00001000 0x00000000
+// Lines are formatted into a large buffer written with a single fwrite
+// when full, much cheaper than the per cycle trace output
+
+inline std::string csr_name(uint32_t id) {
+    static const std::unordered_map<uint32_t, std::string> names = {
+        {0x300, "mstatus"}, {0x304, "mie"}, {0x305, "mtvec"},
+        {0x320, "mcountinhibit"}, {0x340, "mscratch"}, {0x341, "mepc"},
+        {0x342, "mcause"}, {0xb00, "mcycle"}, {0xb02, "minstret"},
+        {0xb80, "mcycleh"}, {0xb82, "minstreth"}
+    };
+    auto it = names.find(id);
+    if (it != names.end()) return it->second;
+    return "unknown";
+}
+
+class CommitLog {
+  public:
+    static constexpr size_t BUFFER_SIZE = 1 << 22;
+
+    bool enabled = false;
+    std::FILE* f = nullptr;
+    std::string buffer;
+
+    AccessMonitor access;
+
+    void init(const std::string output) {
+        f = std::fopen(output.c_str(), "w");
+        if (f == nullptr) {
+            std::cerr << "Cannot open commit log " << output << '\n';
+            return;
+        }
+        enabled = true;
+        buffer.reserve(BUFFER_SIZE + 256);
+    }
+
+    void cycle(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+        if (!enabled) return;
+
+        if (rm.retired) write_retired(rvtop);
+
+        // Accesses of the instruction leaving mem this cycle
+        access.capture(rvtop);
+    }
+
+    void write_retired(const Vrv32_top* rvtop) {
+        auto wbd = get_wb_stage_data(rvtop);
+        auto out = std::back_inserter(buffer);
+
+        std::format_to(out, "core   0: 3 0x{:08x} (0x{:08x})", wbd.pc, wbd.instr.get());
+
+        if (wbd.control.register_wb) {
+            std::format_to(out, " x{:<2d} 0x{:08x}",
+                static_cast<uint32_t>(wbd.instr.rd), get_wb_result_data(rvtop));
+        }
+
+        // csrrs/csrrc with rs1 = x0 (or zero immediate) do not write
+        Instruction instr = wbd.instr;
+        bool csr_writes = (instr.funct3 & 0b11) == 0b01 || instr.rs1 != 0;
+        if (access.csr_of(wbd.pc) && csr_writes) {
+            const auto& csr = access.csr;
+            std::format_to(out, " c{}_{} 0x{:08x}", csr.addr, csr_name(csr.addr), csr.data);
+        }
+
+        if (access.mem_of(wbd.pc)) {
+            const auto& mem = access.mem;
+            std::format_to(out, " mem 0x{:08x}", mem.addr);
+            // Stores log the value with the access width
+            switch (mem.op) {
+                case RV32Types::MEM_SB:
+                    std::format_to(out, " 0x{:02x}", mem.data & 0xff);
+                    break;
+                case RV32Types::MEM_SH:
+                    std::format_to(out, " 0x{:04x}", mem.data & 0xffff);
+                    break;
+                case RV32Types::MEM_SW:
+                    std::format_to(out, " 0x{:08x}", mem.data);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        buffer += '\n';
+        if (buffer.size() >= BUFFER_SIZE) flush();
+    }
+
+    void flush() {
+        if (!enabled) return;
+        std::fwrite(buffer.data(), 1, buffer.size(), f);
+        buffer.clear();
+    }
+
+    void close() {
+        if (!enabled) return;
+        flush();
+        std::fclose(f);
+        enabled = false;
+    }
+};
+
+static CommitLog commit_log;
+
+}
+
+#endif
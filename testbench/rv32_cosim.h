@@ -0,0 +1,182 @@
+#ifndef RV32_COSIM
+#define RV32_COSIM
+
+#include <array>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include "rv32_test_utils.h"
+#include "rv32_memory_utils.h"
+#include "rv32_elf_symbols.h"
+#include "rv32_iss.h"
+
+namespace rv32_test {
+
+// Exit code of the first divergence between the RTL and the ISS
+constexpr int COSIM_MISMATCH_EXIT = 254;
+
+// Lockstep co-simulation, every instruction retired by the RTL is also
+// executed by the ISS and their effects compared:
+// - pc and instruction
+// - register file write request, index and value
+// - memory access, address, op and store data
+// - CSR write request
+// MMIO loads and counter CSR reads depend on timing, the ISS takes the
+// RTL value. The first mismatch stops the simulation
+// The ISS models the GRNG warm up as instantaneous and steps it once per
+// genum, programs must wait the warm up after set seed like custom.h does
+class Cosim {
+  public:
+    static constexpr size_t HISTORY_SIZE = 16;
+
+    bool enabled = false;
+    RV32ISS iss;
+    AccessMonitor access;
+
+    const SymbolTable* symbols = nullptr;
+    const DissasemblyMap* disassembly = nullptr;
+
+    // Last retired instructions, printed on mismatch
+    std::array<ISSStep, HISTORY_SIZE> history;
+    uint64_t checked = 0;
+
+    void init(const rv32_memory& rvmem, const SymbolTable* s, const DissasemblyMap* d) {
+        enabled = true;
+        symbols = s;
+        disassembly = d;
+        iss.init(rvmem.memory.get(), rvmem.max_addr);
+    }
+
+    // Continue from the state of a fast-forward run
+    void resume(const RV32ISS& state) {
+        iss = state;
+        iss.mmio_load = nullptr;
+        iss.mmio_store = nullptr;
+    }
+
+    void cycle(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+        if (!enabled) return;
+        if (rm.retired) check(rvtop, rm);
+        access.capture(rvtop);
+    }
+
+    void check(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+        auto wbd = get_wb_stage_data(rvtop);
+        uint32_t rtl_instr = wbd.instr.get();
+        bool rtl_rd_write = wbd.control.register_wb;
+        uint32_t rtl_rd = wbd.instr.rd;
+        uint32_t rtl_rd_value = get_wb_result_data(rvtop);
+
+        ISSStep s = iss.step();
+        history[checked % HISTORY_SIZE] = s;
+        checked++;
+
+        // Values the ISS cannot know
+        if (s.external && s.rd_write && rtl_rd_write && rtl_rd == s.rd) {
+            iss.x[s.rd] = rtl_rd_value;
+            s.rd_value = rtl_rd_value;
+            history[(checked - 1) % HISTORY_SIZE] = s;
+        }
+
+        if (s.pc != wbd.pc) {
+            mismatch(rm, s, "pc", s.pc, wbd.pc);
+        }
+        if (s.instr != rtl_instr) {
+            mismatch(rm, s, "instruction", s.instr, rtl_instr);
+        }
+        if (s.rd_write != rtl_rd_write) {
+            mismatch(rm, s, "register write", s.rd_write, rtl_rd_write);
+        }
+        if (s.rd_write) {
+            if (s.rd != rtl_rd) mismatch(rm, s, "rd", s.rd, rtl_rd);
+            if (s.rd_value != rtl_rd_value) {
+                mismatch(rm, s, std::format("x{} value", s.rd), s.rd_value, rtl_rd_value);
+            }
+        }
+
+        bool rtl_mem = access.mem_of(wbd.pc);
+        if (s.mem_access != rtl_mem) {
+            mismatch(rm, s, "memory access", s.mem_access, rtl_mem);
+        }
+        if (s.mem_access) {
+            const auto& mem = access.mem;
+            if (s.mem_addr != mem.addr) mismatch(rm, s, "memory address", s.mem_addr, mem.addr);
+            if (s.mem_op != mem.op) mismatch(rm, s, "memory op", s.mem_op, mem.op);
+            if (s.store && s.mem_data != mem.data) {
+                mismatch(rm, s, "store data", s.mem_data, mem.data);
+            }
+        }
+
+        bool rtl_csr = access.csr_of(wbd.pc);
+        if (s.csr_write != rtl_csr) {
+            mismatch(rm, s, "CSR write", s.csr_write, rtl_csr);
+        }
+        if (s.csr_write) {
+            const auto& csr = access.csr;
+            if (s.csr_id != csr.addr) mismatch(rm, s, "CSR id", s.csr_id, csr.addr);
+            // Counter values are timing dependent, follow the RTL
+            if (RV32ISS::is_counter_csr(s.csr_id)) iss.write_csr(s.csr_id, csr.data);
+            else if (s.csr_value != csr.data) {
+                mismatch(rm, s, "CSR value", s.csr_value, csr.data);
+            }
+        }
+    }
+
+    std::string describe(uint32_t pc, uint32_t instr) const {
+        std::string location = symbols ? symbols->location(pc) : "";
+        std::string text = "";
+        if (disassembly) {
+            auto it = disassembly->find(pc);
+            if (it != disassembly->end()) text = it->second;
+        }
+        return std::format("0x{:08x} (0x{:08x}) {:<24} {}", pc, instr, location, text);
+    }
+
+    [[noreturn]] void mismatch(const RetireMonitor& rm, const ISSStep& s,
+        const std::string& field, uint32_t expected, uint32_t actual) {
+
+        std::cerr << "\nCosim mismatch on " << field << '\n';
+        std::cerr << std::format("  cycle {} instret {}\n", rm.cycles, rm.instret);
+        std::cerr << "  " << describe(s.pc, s.instr) << '\n';
+        std::cerr << std::format("  ISS 0x{:08x} RTL 0x{:08x}\n", expected, actual);
+
+        if (s.mem_access) {
+            std::cerr << std::format("  ISS memory op {:04b} addr 0x{:08x} data 0x{:08x}\n",
+                s.mem_op, s.mem_addr, s.mem_data);
+        }
+        if (access.mem.valid) {
+            std::cerr << std::format("  RTL memory op {:04b} addr 0x{:08x} data 0x{:08x} pc 0x{:08x}\n",
+                access.mem.op, access.mem.addr, access.mem.data, access.mem.pc);
+        }
+
+        std::cerr << "\nLast retired instructions\n";
+        uint64_t first = checked > HISTORY_SIZE ? checked - HISTORY_SIZE : 0;
+        for (uint64_t i = first; i < checked; i++) {
+            const auto& h = history[i % HISTORY_SIZE];
+            std::cerr << "  " << describe(h.pc, h.instr);
+            if (h.rd_write) std::cerr << std::format(" x{}=0x{:08x}", h.rd, h.rd_value);
+            std::cerr << '\n';
+        }
+
+        std::cerr << "\nISS registers\n";
+        for (uint32_t r = 0; r < 32; r++) {
+            std::cerr << std::format("  x{:<2} 0x{:08x}", r, iss.x[r]);
+            if (r % 4 == 3) std::cerr << '\n';
+        }
+        enabled = false;
+        std::exit(COSIM_MISMATCH_EXIT);
+    }
+
+    void print() {
+        if (!enabled) return;
+        std::cout << "Cosim " << checked << " instructions matched\n";
+    }
+};
+
+static Cosim cosim;
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef RV32_ELF_SYMBOLS
+#define RV32_ELF_SYMBOLS
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <vector>
+
+#include "rv32_test_utils.h"
+
+namespace rv32_test {
+
+struct ElfSymbol {
+    uint32_t addr;
+    uint32_t size;
+    std::string name;
+};
+
+// Code symbols of the executable sorted by address
+class SymbolTable {
+  public:
+    std::vector<ElfSymbol> symbols;
+
+    // Symbol containing addr, nullptr if addr is before the first one
+    const ElfSymbol* find(uint32_t addr) const {
+        auto it = std::upper_bound(symbols.begin(), symbols.end(), addr,
+            [](uint32_t a, const ElfSymbol& s) { return a < s.addr; });
+        if (it == symbols.begin()) return nullptr;
+        return &(*(it - 1));
+    }
+
+    std::string name(uint32_t addr) const {
+        const ElfSymbol* s = find(addr);
+        if (s == nullptr) return "???";
+        return s->name;
+    }
+
+    // "symbol+offset" string
+    std::string location(uint32_t addr) const {
+        const ElfSymbol* s = find(addr);
+        if (s == nullptr) return std::format("{:#x}", addr);
+        if (s->addr == addr) return s->name;
+        return std::format("{}+{:#x}", s->name, addr - s->addr);
+    }
+
+    // Address of a symbol by name, false if not found
+    bool address(const std::string& name, uint32_t& addr) const {
+        for (const ElfSymbol& s : symbols) {
+            if (s.name == name) {
+                addr = s.addr;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+inline SymbolTable load_symbols(const std::string filename) {
+    SymbolTable table;
+
+    std::ifstream f(filename, std::ios::binary);
+    if (!f.is_open()) return table;
+
+    Elf32_Ehdr ehdr;
+    f.read(reinterpret_cast<char*>(&ehdr), sizeof(ehdr));
+    if (ehdr.e_ident[EI_CLASS] != 1 || ehdr.e_shnum == 0) return table;
+
+    // Read all section headers
+    std::vector<Elf32_Shdr> shdrs(ehdr.e_shnum);
+    f.seekg(ehdr.e_shoff);
+    f.read(reinterpret_cast<char*>(shdrs.data()), ehdr.e_shnum * sizeof(Elf32_Shdr));
+
+    for (const Elf32_Shdr& sh : shdrs) {
+        if (sh.sh_type != SHT_SYMTAB) continue;
+        if (sh.sh_link >= shdrs.size()) continue;
+
+        // Symbol name table
+        const Elf32_Shdr& strsh = shdrs[sh.sh_link];
+        std::vector<char> strtab(strsh.sh_size + 1, 0);
+        f.seekg(strsh.sh_offset);
+        f.read(strtab.data(), strsh.sh_size);
+
+        uint32_t num_syms = sh.sh_size / sizeof(Elf32_Sym);
+        std::vector<Elf32_Sym> syms(num_syms);
+        f.seekg(sh.sh_offset);
+        f.read(reinterpret_cast<char*>(syms.data()), num_syms * sizeof(Elf32_Sym));
+
+        for (const Elf32_Sym& sym : syms) {
+            uint8_t type = ELF32_ST_TYPE(sym.st_info);
+            if (type != STT_FUNC && type != STT_NOTYPE) continue;
+            if (sym.st_shndx == SHN_UNDEF || sym.st_shndx >= shdrs.size()) continue;
+            // Only symbols of code sections
+            if (!(shdrs[sym.st_shndx].sh_flags & SHF_EXECINSTR)) continue;
+            if (sym.st_name >= strsh.sh_size) continue;
+
+            std::string name = &strtab[sym.st_name];
+            // Ignore local labels and mapping symbols
+            if (name == "" || name[0] == '$' || name.starts_with(".L")) continue;
+
+            table.symbols.push_back({sym.st_value, sym.st_size, name});
+        }
+    }
+
+    // Sort by address, functions with size first for duplicated addresses
+    std::stable_sort(table.symbols.begin(), table.symbols.end(),
+        [](const ElfSymbol& a, const ElfSymbol& b) {
+            if (a.addr != b.addr) return a.addr < b.addr;
+            return a.size > b.size;
+        });
+    auto last = std::unique(table.symbols.begin(), table.symbols.end(),
+        [](const ElfSymbol& a, const ElfSymbol& b) { return a.addr == b.addr; });
+    table.symbols.erase(last, table.symbols.end());
+
+    return table;
+}
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef RV32_FAST_FORWARD
+#define RV32_FAST_FORWARD
+
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_memory_utils.h"
+#include "rv32_mmio_profiler.h"
+#include "rv32_elf_symbols.h"
+#include "rv32_iss.h"
+
+#include "Vrv32_top_clt_grng_16.h"
+#include "Vrv32_top_lfsr_151_144.h"
+#include "Vrv32_top_adder_tree_12_12.h"
+
+namespace rv32_test {
+
+// RV32I encoders used to build the restore stub
+namespace encode {
+    inline uint32_t i_type(uint32_t opcode, uint32_t rd, uint32_t funct3, uint32_t rs1, uint32_t imm) {
+        return ((imm & 0xfff) << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+    }
+    inline uint32_t lui(uint32_t rd, uint32_t imm20) {
+        return ((imm20 & 0xfffff) << 12) | (rd << 7) | 0b0110111;
+    }
+    inline uint32_t addi(uint32_t rd, uint32_t rs1, uint32_t imm) {
+        return i_type(0b0010011, rd, 0b000, rs1, imm);
+    }
+    inline uint32_t jalr(uint32_t rd, uint32_t rs1, uint32_t imm) {
+        return i_type(0b1100111, rd, 0b000, rs1, imm);
+    }
+    inline uint32_t csrw(uint32_t csr, uint32_t rs1) {
+        return i_type(0b1110011, 0, 0b001, rs1, csr);
+    }
+    inline uint32_t sw(uint32_t rs2, uint32_t rs1, uint32_t imm) {
+        return (((imm >> 5) & 0x7f) << 25) | (rs2 << 20) | (rs1 << 15) |
+            (0b010 << 12) | ((imm & 0x1f) << 7) | 0b0100011;
+    }
+    inline uint32_t jal(uint32_t rd, uint32_t offset) {
+        return (((offset >> 20) & 1) << 31) | (((offset >> 1) & 0x3ff) << 21) |
+            (((offset >> 11) & 1) << 20) | (((offset >> 12) & 0xff) << 12) |
+            (rd << 7) | 0b1101111;
+    }
+    // lui + addi, always 2 instructions
+    inline void li(std::vector<uint32_t>& code, uint32_t rd, uint32_t value) {
+        uint32_t hi = (value + 0x800) >> 12;
+        uint32_t lo = value - (hi << 12);
+        code.push_back(lui(rd, hi));
+        code.push_back(addi(rd, rd, lo));
+    }
+}
+
+// MMIO stores of a functional ISS run, fast-forward and sampling
+inline void iss_mmio_store(uint32_t addr, uint32_t data, uint32_t op) {
+    if (addr == PRINT_REG_ADDR && op == RV32Types::MEM_SW) {
+        std::cout << static_cast<char>(data);
+    }
+    else if (addr == EXIT_STATUS_ADDR && op == RV32Types::MEM_SW) {
+        std::cout << '\n' << "Exit status " << data << '\n';
+        std::cout << "Exit in the functional ISS\n";
+        print_profiler_counters();
+        std::exit(data);
+    }
+    // Region timing needs the RTL, only names are kept
+    else if (addr >= PROFILER_BASE_ADDR + 12 && addr <= PROFILER_BASE_ADDR + 16) {
+        profiler_store(addr, op, data);
+    }
+}
+
+// Functional fast-forward of the start of a program in the ISS
+// Runs the first N instructions or up to a symbol, then the RTL boots from
+// the ISS state. Registers, CSRs and pc are restored by a stub appended
+// after the program image, reached from pc 0:
+//   0: lui x1, %hi(stub); jalr x0, %lo(stub)(x1)
+//   stub: restore words 0 and 4, flush the data cache, CSRs with the
+//         counters inhibited, x2..x31, mcountinhibit, x1, jump to the
+//         resume pc
+// The GRNG state is not reachable from software and is written into the
+// RTL once the stub jump retires. The counters run for the last few
+// stub cycles. Per cycle monitors start after the stub
+class FastForward {
+  public:
+    bool enabled = false;
+    RV32ISS iss;
+
+    // Stop conditions, first one reached
+    uint64_t max_instructions = 0;
+    bool stop_at_addr = false;
+    uint32_t stop_addr = 0;
+
+    uint32_t stub_addr = 0;
+    uint32_t jump_pc = 0;
+    bool restored = false;
+
+    // Run the ISS over the ELF image, returns the memory the RTL boots from
+    rv32_memory run(const rv32_memory& rvmem, uint64_t instructions,
+        const std::string& symbol, const SymbolTable& symbols) {
+
+        enabled = true;
+        max_instructions = instructions;
+        if (symbol != "") {
+            stop_at_addr = symbols.address(symbol, stop_addr);
+            if (!stop_at_addr) {
+                std::cerr << "Fast-forward symbol " << symbol << " not found\n";
+                std::exit(255);
+            }
+        }
+
+        iss.init(rvmem.memory.get(), rvmem.max_addr);
+        iss.mmio_store = iss_mmio_store;
+
+        while (true) {
+            if (max_instructions != 0 && iss.instret >= max_instructions) break;
+            if (stop_at_addr && iss.pc == stop_addr) break;
+            iss.step();
+        }
+
+        std::cout << std::format("Fast-forward {} instructions to 0x{:08x} {}\n",
+            iss.instret, iss.pc, symbols.location(iss.pc));
+
+        return build_image();
+    }
+
+    rv32_memory build_image() {
+        uint32_t image_size = static_cast<uint32_t>(iss.memory.size());
+        stub_addr = (image_size + 3) & ~3u;
+
+        std::vector<uint32_t> stub;
+        uint32_t word0 = iss.fetch(0), word1 = iss.fetch(4);
+        encode::li(stub, 1, word0);
+        stub.push_back(encode::sw(1, 0, 0));
+        encode::li(stub, 1, word1);
+        stub.push_back(encode::sw(1, 0, 4));
+        // Flushed so the data cache does not keep them from fetch
+        encode::li(stub, 1, 0b11);
+        encode::li(stub, 2, DCACHE_CTRL_ADDR);
+        stub.push_back(encode::sw(1, 2, 0));
+
+        encode::li(stub, 1, RV32ISS::MCOUNTINHIBIT_MASK);
+        stub.push_back(encode::csrw(RV32ISS::CSR_MCOUNTINHIBIT, 1));
+        encode::li(stub, 1, iss.mscratch);
+        stub.push_back(encode::csrw(RV32ISS::CSR_MSCRATCH, 1));
+        encode::li(stub, 1, static_cast<uint32_t>(iss.mcycle));
+        stub.push_back(encode::csrw(RV32ISS::CSR_MCYCLE, 1));
+        encode::li(stub, 1, static_cast<uint32_t>(iss.mcycle >> 32));
+        stub.push_back(encode::csrw(RV32ISS::CSR_MCYCLEH, 1));
+        encode::li(stub, 1, static_cast<uint32_t>(iss.minstret));
+        stub.push_back(encode::csrw(RV32ISS::CSR_MINSTRET, 1));
+        encode::li(stub, 1, static_cast<uint32_t>(iss.minstret >> 32));
+        stub.push_back(encode::csrw(RV32ISS::CSR_MINSTRETH, 1));
+        // Only the hpm CSRs written while fast-forwarding
+        for (uint32_t k = 0; k < RV32ISS::MAX_HPM_COUNTERS; k++) {
+            if (iss.mhpmevent[k] != 0) {
+                encode::li(stub, 1, iss.mhpmevent[k]);
+                stub.push_back(encode::csrw(RV32ISS::CSR_MHPMEVENT3 + k, 1));
+            }
+            if (iss.mhpmcounter[k] != 0) {
+                encode::li(stub, 1, static_cast<uint32_t>(iss.mhpmcounter[k]));
+                stub.push_back(encode::csrw(RV32ISS::CSR_MHPMCOUNTER3 + k, 1));
+                encode::li(stub, 1, static_cast<uint32_t>(iss.mhpmcounter[k] >> 32));
+                stub.push_back(encode::csrw(RV32ISS::CSR_MHPMCOUNTER3H + k, 1));
+            }
+        }
+
+        for (uint32_t r = 2; r < 32; r++) encode::li(stub, r, iss.x[r]);
+
+        encode::li(stub, 1, iss.mcountinhibit);
+        stub.push_back(encode::csrw(RV32ISS::CSR_MCOUNTINHIBIT, 1));
+        encode::li(stub, 1, iss.x[1]);
+
+        jump_pc = stub_addr + static_cast<uint32_t>(stub.size()) * 4;
+        int64_t offset = static_cast<int64_t>(iss.pc) - jump_pc;
+        if (iss.pc < 2048) stub.push_back(encode::jalr(0, 0, iss.pc));
+        else if (offset >= -(1 << 20) && offset < (1 << 20)) {
+            stub.push_back(encode::jal(0, static_cast<uint32_t>(offset)));
+        } else {
+            std::cerr << std::format("Fast-forward pc 0x{:08x} out of the stub jump range\n", iss.pc);
+            std::exit(255);
+        }
+
+        // Padded so instruction cache line refills of the stub stay in memory
+        rv32_memory m;
+        m.max_addr = (jump_pc + 4 + 255) & ~255u;
+        m.memory = std::unique_ptr<uint8_t>(new uint8_t[m.max_addr]());
+        std::memcpy(m.memory.get(), iss.memory.data(), image_size);
+        std::memcpy(m.memory.get() + stub_addr, stub.data(), stub.size() * 4);
+
+        uint32_t entry[2] = {
+            encode::lui(1, (stub_addr + 0x800) >> 12),
+            encode::jalr(0, 1, stub_addr - (((stub_addr + 0x800) >> 12) << 12))
+        };
+        std::memcpy(m.memory.get(), entry, sizeof(entry));
+        return m;
+    }
+
+    // Write the ISS GRNG registers into the RTL
+    void write_grng(Vrv32_top* rvtop) {
+        auto* grng = rvtop->rv32_top->core->exec_stage->grng;
+        const auto& g = iss.grng;
+        // Warm up done
+        grng->current_state = 0;
+
+        auto& state = grng->urng->current_state;
+        for (uint32_t w = 0; w < 5; w++) state[w] = 0;
+        for (uint32_t b = 0; b < GRNGModel::STATE_BITS; b++) {
+            state[b / 32] |= static_cast<uint32_t>(g.state[b]) << (b % 32);
+        }
+
+        auto* tree = grng->adder_tree;
+        for (uint32_t w = 0; w < 3; w++) tree->buff_l0l1[w] = 0;
+        for (uint32_t i = 0; i < 6; i++) {
+            for (uint32_t b = 0; b < 13; b++) {
+                uint32_t bit = i * 13 + b;
+                tree->buff_l0l1[bit / 32] |= ((g.l0[i] >> b) & 1) << (bit % 32);
+            }
+        }
+        uint64_t l1 = 0;
+        for (uint32_t i = 0; i < 3; i++) l1 |= static_cast<uint64_t>(g.l1[i] & 0x3fff) << (i * 14);
+        tree->buff_l1l2 = l1;
+        uint32_t l2 = 0;
+        for (uint32_t i = 0; i < 2; i++) l2 |= (g.l2[i] & 0x7fff) << (i * 15);
+        tree->buff_l2l3 = l2;
+        tree->result = static_cast<uint16_t>(g.result);
+    }
+
+    // True while the stub runs, call once per cycle
+    bool restoring(Vrv32_top* rvtop, RetireMonitor& rm) {
+        if (!enabled || restored) return false;
+        if (rm.retired && get_wb_stage_data(rvtop).pc == jump_pc) {
+            write_grng(rvtop);
+            restored = true;
+            rm.cycles = 0;
+            rm.instret = 0;
+        }
+        return true;
+    }
+};
+
+static FastForward fast_forward;
+
+}
+
+#endif
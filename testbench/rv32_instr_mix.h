@@ -0,0 +1,191 @@
+#ifndef RV32_INSTR_MIX
+#define RV32_INSTR_MIX
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <format>
+#include <unordered_map>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_elf_symbols.h"
+#include "rv32_trace_stages.h"
+
+namespace rv32_test {
+
+// Dynamic instruction mix of the retired instructions
+// Branch outcome is known when the next instruction retires, a branch is
+// taken if the next retired pc is not pc + 4
+class InstrMix {
+  public:
+    bool enabled = false;
+    std::string output = "";
+    const SymbolTable* symbols = nullptr;
+
+    uint64_t total = 0;
+    std::array<uint64_t, 128> opcodes = {};
+    std::array<uint64_t, 16> alu_ops = {};
+    std::array<uint64_t, 16> mem_ops = {};
+    std::array<uint64_t, 16> branch_taken = {};
+    std::array<uint64_t, 16> branch_not_taken = {};
+    std::array<uint64_t, 4> mul_ops = {};
+    std::array<uint64_t, 4> div_ops = {};
+    std::array<uint64_t, 8> csr_ops = {};
+    uint64_t grng_gen = 0, grng_seed = 0;
+
+    // Opcode histogram of each function
+    std::unordered_map<const ElfSymbol*, std::array<uint64_t, 128>> function_opcodes;
+
+    // Branch waiting for the next retired pc
+    bool pending_branch = false;
+    uint32_t pending_pc = 0;
+    uint32_t pending_op = 0;
+
+    void init(const std::string out, const SymbolTable* table) {
+        enabled = true;
+        output = out;
+        symbols = table;
+    }
+
+    void cycle(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+        if (!enabled || !rm.retired) return;
+
+        auto wbd = get_wb_stage_data(rvtop);
+
+        if (pending_branch) {
+            if (wbd.pc == pending_pc + 4) branch_not_taken[pending_op]++;
+            else branch_taken[pending_op]++;
+            pending_branch = false;
+        }
+
+        uint32_t opcode = wbd.instr.opcode;
+        total++;
+        opcodes[opcode]++;
+        function_opcodes[symbols->find(wbd.pc)][opcode]++;
+
+        if (wbd.control.mem_op != RV32Types::MEM_NOP) mem_ops[wbd.control.mem_op]++;
+
+        if (wbd.control.branch_op != RV32Types::OP_NOP) {
+            pending_branch = true;
+            pending_pc = wbd.pc;
+            pending_op = wbd.control.branch_op;
+        }
+
+        switch (wbd.control.wb_result_src) {
+            case RV32Types::WB_INT_ALU:
+                alu_ops[wbd.control.int_alu_instr.op]++;
+                break;
+            case RV32Types::WB_MUL_UNIT:
+                mul_ops[wbd.instr.funct3 & 0b11]++;
+                break;
+            case RV32Types::WB_DIV_UNIT:
+                div_ops[wbd.instr.funct3 & 0b11]++;
+                break;
+            case RV32Types::WB_CSR:
+                csr_ops[wbd.instr.funct3]++;
+                break;
+            default:
+                break;
+        }
+
+        if (wbd.control.grng_ctrl.enable) grng_gen++;
+        if (wbd.control.grng_ctrl.set_seed) grng_seed++;
+    }
+
+    void write_histogram(std::ofstream& f, const std::string& title,
+        const std::vector<std::pair<std::string, uint64_t>>& entries) const {
+
+        f << "\n" << title << "\n";
+        for (auto& [name, n] : entries) {
+            if (n == 0) continue;
+            f << std::format("  {:<16} {:>14} {:>7.2f}%\n",
+                name, n, total ? 100.0 * n / total : 0);
+        }
+    }
+
+    void write() const {
+        if (!enabled) return;
+
+        std::ofstream f(output);
+        if (!f.is_open()) {
+            std::cerr << "Cannot open instruction mix output " << output << '\n';
+            return;
+        }
+
+        f << std::format("Instruction mix, {} retired instructions\n", total);
+
+        std::vector<std::pair<std::string, uint64_t>> e;
+        for (uint32_t i = 0; i < opcodes.size(); i++) {
+            if (opcodes[i]) e.push_back({opcode_name(i), opcodes[i]});
+        }
+        write_histogram(f, "Opcode", e);
+
+        e.clear();
+        for (uint32_t i = 0; i < alu_ops.size(); i++) e.push_back({alu_op_name(i), alu_ops[i]});
+        write_histogram(f, "Int ALU op", e);
+
+        e.clear();
+        for (uint32_t i = 0; i < mem_ops.size(); i++) e.push_back({mem_op_name(i), mem_ops[i]});
+        write_histogram(f, "Memory op", e);
+
+        e.clear();
+        for (uint32_t i = 0; i < branch_taken.size(); i++) {
+            e.push_back({branch_op_name(i) + " taken", branch_taken[i]});
+            e.push_back({branch_op_name(i) + " not taken", branch_not_taken[i]});
+        }
+        write_histogram(f, "Branch op", e);
+
+        static const std::array<std::string, 4> mul_names = {
+            "MUL", "MULH", "MULHSU", "MULHU"
+        };
+        e.clear();
+        for (uint32_t i = 0; i < mul_ops.size(); i++) e.push_back({mul_names[i], mul_ops[i]});
+        write_histogram(f, "Mul unit", e);
+
+        static const std::array<std::string, 4> div_names = {
+            "DIV", "DIVU", "REM", "REMU"
+        };
+        e.clear();
+        for (uint32_t i = 0; i < div_ops.size(); i++) e.push_back({div_names[i], div_ops[i]});
+        write_histogram(f, "Div unit", e);
+
+        static const std::array<std::string, 8> csr_names = {
+            "???", "CSRRW", "CSRRS", "CSRRC", "???", "CSRRWI", "CSRRSI", "CSRRCI"
+        };
+        e.clear();
+        for (uint32_t i = 0; i < csr_ops.size(); i++) e.push_back({csr_names[i], csr_ops[i]});
+        write_histogram(f, "Zicsr", e);
+
+        write_histogram(f, "GRNG", {{"GENUM", grng_gen}, {"SETSEED", grng_seed}});
+
+        // Per function opcode mix, functions sorted by retired instructions
+        std::vector<std::pair<const ElfSymbol*, uint64_t>> functions;
+        for (auto& [s, ops] : function_opcodes) {
+            uint64_t n = 0;
+            for (uint64_t o : ops) n += o;
+            functions.push_back({s, n});
+        }
+        std::sort(functions.begin(), functions.end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        f << "\nPer function\n";
+        for (auto& [s, n] : functions) {
+            f << std::format("\n{} {} instructions\n", s == nullptr ? "???" : s->name, n);
+            const auto& ops = function_opcodes.at(s);
+            for (uint32_t i = 0; i < ops.size(); i++) {
+                if (ops[i] == 0) continue;
+                f << std::format("  {:<16} {:>14} {:>7.2f}%\n",
+                    opcode_name(i), ops[i], 100.0 * ops[i] / n);
+            }
+        }
+
+        std::cout << "Instruction mix written to " << output << '\n';
+    }
+};
+
+static InstrMix instr_mix;
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef RV32_INTERVAL_STATS
+#define RV32_INTERVAL_STATS
+
+#include <array>
+#include <iostream>
+#include <format>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_elf_symbols.h"
+#include "rv32_pipeline_stats.h"
+#include "rv32_mmio_profiler.h"
+
+#include "../bsp/include/riscv/config.h"
+
+namespace rv32_test {
+
+// Interval time series
+// Every period cycles one CSV row is streamed to the output file with the
+// activity of that interval, memory use does not grow with the run length
+class IntervalStats {
+  public:
+    bool enabled = false;
+    uint64_t period = 0;
+    std::ofstream f;
+    const SymbolTable* symbols = nullptr;
+    const PipelineStats* stats = nullptr;
+
+    // Interval counters
+    uint64_t start_cycle = 0;
+    uint64_t cycles = 0;
+    std::array<uint64_t, NUM_CYCLE_CATEGORIES> start_categories = {};
+    uint64_t loads = 0, stores = 0;
+    uint64_t mmio_reads = 0, mmio_writes = 0;
+    uint64_t start_profiler_events = 0;
+    // Cycles per symbol, last entry for pcs without symbol
+    std::vector<uint64_t> symbol_cycles;
+
+    void init(uint64_t p, const std::string output,
+        const SymbolTable* table, const PipelineStats* pipeline_stats) {
+
+        f.open(output);
+        if (!f.is_open()) {
+            std::cerr << "Cannot open interval stats file " << output << '\n';
+            return;
+        }
+
+        enabled = true;
+        period = p;
+        symbols = table;
+        stats = pipeline_stats;
+        symbol_cycles.assign(symbols->symbols.size() + 1, 0);
+
+        f << "start_cycle,cycles,instructions,ipc";
+        for (uint32_t c = 0; c < NUM_CYCLE_CATEGORIES; c++) {
+            f << "," << cycle_category_str(c);
+        }
+        f << ",loads,stores,mmio_reads,mmio_writes";
+        f << ",profiler_events,active_regions,hot_symbol,hot_symbol_pct\n";
+    }
+
+    void cycle(const Vrv32_top* rvtop, const RetireMonitor& rm, uint64_t cycle) {
+        if (!enabled) return;
+
+        if (cycles == 0) start_cycle = cycle;
+        cycles++;
+
+        // Memory access leaving the memory stage
+        auto mem_data = get_mem_stage_data(rvtop);
+        auto op = static_cast<RV32Types::mem_op_t>(mem_data.control.mem_op);
+        if (op != RV32Types::MEM_NOP && !get_memory_stall(rvtop)) {
+            bool store = op & 0b1000;
+            bool mmio = get_mem_stage_request(rvtop).addr >= PRINT_REG_ADDR;
+            if (mmio) {
+                mmio_writes += store;
+                mmio_reads += !store;
+            } else {
+                stores += store;
+                loads += !store;
+            }
+        }
+
+        const ElfSymbol* s = symbols->find(get_oldest_pc(rvtop, rm));
+        if (s == nullptr) symbol_cycles.back()++;
+        else symbol_cycles[s - symbols->symbols.data()]++;
+
+        if (cycles == period) write_row();
+    }
+
+    void write_row() {
+        if (!enabled || cycles == 0) return;
+
+        uint64_t instructions = stats->cycles[CYCLE_RETIRE] - start_categories[CYCLE_RETIRE];
+        f << std::format("{},{},{},{:.4f}", start_cycle, cycles, instructions,
+            static_cast<double>(instructions) / cycles);
+        for (uint32_t c = 0; c < NUM_CYCLE_CATEGORIES; c++) {
+            f << "," << stats->cycles[c] - start_categories[c];
+        }
+        f << std::format(",{},{},{},{}", loads, stores, mmio_reads, mmio_writes);
+
+        // Profiler regions open at the end of the interval
+        f << std::format(",{},{}", profiler_num_events - start_profiler_events,
+            profiler_active_regions());
+
+        auto hot = std::max_element(symbol_cycles.begin(), symbol_cycles.end());
+        size_t hot_idx = hot - symbol_cycles.begin();
+        std::string hot_name = "???";
+        if (hot_idx < symbols->symbols.size()) hot_name = symbols->symbols[hot_idx].name;
+        f << std::format(",{},{:.2f}\n", hot_name, 100.0 * (*hot) / cycles);
+
+        // Next interval
+        cycles = 0;
+        start_categories = stats->cycles;
+        loads = stores = mmio_reads = mmio_writes = 0;
+        start_profiler_events = profiler_num_events;
+        std::fill(symbol_cycles.begin(), symbol_cycles.end(), 0);
+    }
+
+    // Last partial interval
+    void finish() {
+        write_row();
+        if (enabled) f.close();
+    }
+};
+
+static IntervalStats interval_stats;
+
+}
+
+#endif
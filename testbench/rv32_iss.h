@@ -0,0 +1,470 @@
+#ifndef RV32_ISS
+#define RV32_ISS
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace rv32_test {
+
+// Functional model of the custom GRNG unit (clt_grng_16)
+// 151 bit LFSR feeding a 4 stage pipelined adder tree of 12 12-bit words
+// After reset or set seed the RTL runs 4 cycles on its own to fill the
+// adder tree, here they are run at once (custom.h waits them with nops)
+class GRNGModel {
+  public:
+    static constexpr uint32_t STATE_BITS = 151;
+    using State = std::bitset<STATE_BITS>;
+
+    State state;
+    std::array<uint32_t, 6> l0 = {};
+    std::array<uint32_t, 3> l1 = {};
+    std::array<uint32_t, 2> l2 = {};
+    uint32_t result = 0;
+
+    static State reset_seed() {
+        // RESET_SEED of clt_grng_16, bit 150 first
+        static const char* seed =
+            "0111001100100100110011101101000111101000001000100001000111001100"
+            "0110001011100101111111110111011011101101101100001000010000100101"
+            "10001101000011111001000";
+        return State(std::string(seed));
+    }
+
+    void reset() {
+        state = reset_seed();
+        warm_up();
+    }
+
+    void set_seed(uint32_t seed) {
+        state = reset_seed();
+        for (uint32_t i = 0; i < 32; i++) state[i] = (seed >> i) & 1;
+        warm_up();
+    }
+
+    void warm_up() {
+        for (uint32_t i = 0; i < 4; i++) enable();
+    }
+
+    // 1 clock edge with enable
+    void enable() {
+        std::array<uint32_t, 12> data;
+        for (uint32_t i = 0; i < 12; i++) {
+            data[i] = 0;
+            for (uint32_t b = 0; b < 12; b++) data[i] |= state[i * 12 + b] << b;
+        }
+
+        uint32_t out_l3 = l2[0] + l2[1];
+        std::array<uint32_t, 2> out_l2 = {l1[0] + l1[1], l1[2]};
+        std::array<uint32_t, 3> out_l1;
+        for (uint32_t i = 0; i < 3; i++) out_l1[i] = l0[i * 2] + l0[i * 2 + 1];
+        std::array<uint32_t, 6> out_l0;
+        for (uint32_t i = 0; i < 6; i++) out_l0[i] = data[i * 2] + data[i * 2 + 1];
+
+        result = out_l3 & 0xffff;
+        l2 = out_l2;
+        l1 = out_l1;
+        l0 = out_l0;
+
+        // lfsr_151_144
+        State next;
+        for (uint32_t i = 7; i < STATE_BITS; i++) next[i] = state[i - 4] ^ state[i - 7];
+        for (uint32_t i = 0; i < 7; i++) next[i] = state[i + 144];
+        state = next;
+    }
+
+    // genum, current sample then advance
+    uint32_t gen() {
+        uint32_t sample = ((result - 6) & 0xffff) << 16;
+        enable();
+        return sample;
+    }
+};
+
+// Effects of 1 executed instruction
+struct ISSStep {
+    uint32_t pc = 0;
+    uint32_t instr = 0;
+    // Register write, never x0
+    bool rd_write = false;
+    uint32_t rd = 0;
+    uint32_t rd_value = 0;
+    // Memory access, op as mem_op_t
+    bool mem_access = false;
+    bool store = false;
+    uint32_t mem_op = 0;
+    uint32_t mem_addr = 0;
+    uint32_t mem_data = 0;
+    // CSR write
+    bool csr_write = false;
+    uint32_t csr_id = 0;
+    uint32_t csr_value = 0;
+    // rd value is not known by the ISS, MMIO load or timing dependent CSR
+    bool external = false;
+};
+
+// Instruction set simulator of this core
+// RV32IM, Zicsr and the custom GRNG extension
+// Models the core as built, not the full spec, so it can be compared
+// against the RTL:
+// - No traps, ecall/ebreak/mret/fence and invalid instructions are nops
+// - Only mcountinhibit, mscratch, mcycle(h), minstret(h) and the hpm CSRs,
+//   others read 0. The hpm counters do not count, their number depends on
+//   the RTL config and their reads are taken from the RTL
+// - jalr does not clear the target lsb
+// - Loads read the aligned word, misaligned half words load 0
+// - Stores write at the exact address like the C++ memory model
+class RV32ISS {
+  public:
+    uint32_t pc = 0;
+    std::array<uint32_t, 32> x = {};
+
+    // CSRs
+    uint32_t mcountinhibit = 0;
+    uint32_t mscratch = 0;
+    uint64_t mcycle = 0;
+    uint64_t minstret = 0;
+    static constexpr uint32_t MAX_HPM_COUNTERS = 29;
+    std::array<uint64_t, MAX_HPM_COUNTERS> mhpmcounter = {};
+    std::array<uint32_t, MAX_HPM_COUNTERS> mhpmevent = {};
+
+    GRNGModel grng;
+    std::vector<uint8_t> memory;
+    uint64_t instret = 0;
+
+    // Accesses out of memory go to these hooks, loads not served are 0
+    std::function<bool(uint32_t addr, uint32_t& value)> mmio_load;
+    std::function<void(uint32_t addr, uint32_t data, uint32_t op)> mmio_store;
+
+    // mem_op_t values
+    enum {
+        MEM_LB = 0b0000, MEM_LH = 0b0001, MEM_LW = 0b0010,
+        MEM_LBU = 0b0100, MEM_LHU = 0b0101,
+        MEM_SB = 0b1000, MEM_SH = 0b1001, MEM_SW = 0b1010,
+        MEM_NOP = 0b1111
+    };
+
+    enum {
+        CSR_MCOUNTINHIBIT = 0x320,
+        CSR_MHPMEVENT3 = 0x323,
+        CSR_MSCRATCH = 0x340,
+        CSR_MCYCLE = 0xb00,
+        CSR_MINSTRET = 0xb02,
+        CSR_MHPMCOUNTER3 = 0xb03,
+        CSR_MCYCLEH = 0xb80,
+        CSR_MINSTRETH = 0xb82,
+        CSR_MHPMCOUNTER3H = 0xb83
+    };
+
+    // mcountinhibit keeps all bits but bit 1
+    static constexpr uint32_t MCOUNTINHIBIT_MASK = 0xfffffffd;
+
+    void init(const uint8_t* image, uint32_t size) {
+        memory.assign(image, image + size);
+        pc = 0;
+        x.fill(0);
+        mcountinhibit = 0;
+        mscratch = 0;
+        mcycle = 0;
+        minstret = 0;
+        mhpmcounter.fill(0);
+        mhpmevent.fill(0);
+        instret = 0;
+        grng.reset();
+    }
+
+    bool in_memory(uint32_t addr, uint32_t size) const {
+        return static_cast<uint64_t>(addr) + size <= memory.size();
+    }
+
+    uint32_t fetch(uint32_t addr) const {
+        uint32_t a = addr & ~3u;
+        if (!in_memory(a, 4)) return 0;
+        uint32_t w;
+        std::memcpy(&w, memory.data() + a, 4);
+        return w;
+    }
+
+    // hpm CSR index, MAX_HPM_COUNTERS if id is not one
+    static uint32_t hpm_index(uint32_t id, uint32_t base) {
+        return id >= base && id < base + MAX_HPM_COUNTERS ? id - base : MAX_HPM_COUNTERS;
+    }
+
+    static bool is_hpm_csr(uint32_t id) {
+        return hpm_index(id, CSR_MHPMEVENT3) != MAX_HPM_COUNTERS ||
+            hpm_index(id, CSR_MHPMCOUNTER3) != MAX_HPM_COUNTERS ||
+            hpm_index(id, CSR_MHPMCOUNTER3H) != MAX_HPM_COUNTERS;
+    }
+
+    // Timing or RTL config dependent CSRs
+    static bool is_counter_csr(uint32_t id) {
+        return id == CSR_MCYCLE || id == CSR_MCYCLEH ||
+            id == CSR_MINSTRET || id == CSR_MINSTRETH || is_hpm_csr(id);
+    }
+
+    uint32_t read_csr(uint32_t id) const {
+        uint32_t k;
+        if ((k = hpm_index(id, CSR_MHPMEVENT3)) != MAX_HPM_COUNTERS) return mhpmevent[k];
+        if ((k = hpm_index(id, CSR_MHPMCOUNTER3)) != MAX_HPM_COUNTERS) {
+            return static_cast<uint32_t>(mhpmcounter[k]);
+        }
+        if ((k = hpm_index(id, CSR_MHPMCOUNTER3H)) != MAX_HPM_COUNTERS) {
+            return static_cast<uint32_t>(mhpmcounter[k] >> 32);
+        }
+
+        switch (id) {
+            case CSR_MCOUNTINHIBIT: return mcountinhibit;
+            case CSR_MSCRATCH: return mscratch;
+            case CSR_MCYCLE: return static_cast<uint32_t>(mcycle);
+            case CSR_MCYCLEH: return static_cast<uint32_t>(mcycle >> 32);
+            case CSR_MINSTRET: return static_cast<uint32_t>(minstret);
+            case CSR_MINSTRETH: return static_cast<uint32_t>(minstret >> 32);
+            default: return 0;
+        }
+    }
+
+    void write_csr(uint32_t id, uint32_t v) {
+        uint32_t k;
+        if ((k = hpm_index(id, CSR_MHPMEVENT3)) != MAX_HPM_COUNTERS) {
+            mhpmevent[k] = v;
+            return;
+        }
+        if ((k = hpm_index(id, CSR_MHPMCOUNTER3)) != MAX_HPM_COUNTERS) {
+            mhpmcounter[k] = (mhpmcounter[k] & ~0xffffffffull) | v;
+            return;
+        }
+        if ((k = hpm_index(id, CSR_MHPMCOUNTER3H)) != MAX_HPM_COUNTERS) {
+            mhpmcounter[k] = (mhpmcounter[k] & 0xffffffffull) | (static_cast<uint64_t>(v) << 32);
+            return;
+        }
+
+        switch (id) {
+            case CSR_MCOUNTINHIBIT: mcountinhibit = v & MCOUNTINHIBIT_MASK; break;
+            case CSR_MSCRATCH: mscratch = v; break;
+            case CSR_MCYCLE: mcycle = (mcycle & ~0xffffffffull) | v; break;
+            case CSR_MCYCLEH:
+                mcycle = (mcycle & 0xffffffffull) | (static_cast<uint64_t>(v) << 32);
+                break;
+            case CSR_MINSTRET: minstret = (minstret & ~0xffffffffull) | v; break;
+            case CSR_MINSTRETH:
+                minstret = (minstret & 0xffffffffull) | (static_cast<uint64_t>(v) << 32);
+                break;
+            default: break;
+        }
+    }
+
+    // rv32_int_alu
+    static uint32_t alu(uint32_t op, uint32_t a, uint32_t b) {
+        switch (op) {
+            case 0b0000: return a + b;
+            case 0b0001: return a << (b & 31);
+            case 0b0010: return static_cast<int32_t>(a) < static_cast<int32_t>(b);
+            case 0b0011: return a < b;
+            case 0b0100: return a ^ b;
+            case 0b0101: return a >> (b & 31);
+            case 0b0110: return a | b;
+            case 0b0111: return a & b;
+            case 0b1000: return a - b;
+            case 0b1101: return static_cast<uint32_t>(static_cast<int32_t>(a) >> (b & 31));
+            default: return 0;
+        }
+    }
+
+    // rv32_mul_unit
+    static uint32_t mul(uint32_t op, uint32_t a, uint32_t b) {
+        int64_t sa = static_cast<int32_t>(a), sb = static_cast<int32_t>(b);
+        uint64_t ua = a, ub = b;
+        switch (op & 0b11) {
+            case 0b00: return static_cast<uint32_t>(sa * sb);
+            case 0b01: return static_cast<uint32_t>(static_cast<uint64_t>(sa * sb) >> 32);
+            case 0b10: return static_cast<uint32_t>(static_cast<uint64_t>(sa * static_cast<int64_t>(ub)) >> 32);
+            default: return static_cast<uint32_t>((ua * ub) >> 32);
+        }
+    }
+
+    // rv32_div_unit
+    static uint32_t div(uint32_t op, uint32_t a, uint32_t b) {
+        int32_t sa = static_cast<int32_t>(a), sb = static_cast<int32_t>(b);
+        switch (op & 0b11) {
+            case 0b00: // div
+                if (b == 0) return 0xffffffff;
+                if (a == 0x80000000 && sb == -1) return a;
+                return static_cast<uint32_t>(sa / sb);
+            case 0b01: // divu
+                return b == 0 ? 0xffffffff : a / b;
+            case 0b10: // rem
+                if (b == 0) return a;
+                if (a == 0x80000000 && sb == -1) return 0;
+                return static_cast<uint32_t>(sa % sb);
+            default: // remu
+                return b == 0 ? a : a % b;
+        }
+    }
+
+    // rv32_branch_unit
+    static bool branch(uint32_t funct3, uint32_t a, uint32_t b) {
+        switch (funct3) {
+            case 0b000: return a == b;
+            case 0b001: return a != b;
+            case 0b100: return static_cast<int32_t>(a) < static_cast<int32_t>(b);
+            case 0b101: return static_cast<int32_t>(a) >= static_cast<int32_t>(b);
+            case 0b110: return a < b;
+            case 0b111: return a >= b;
+            default: return false;
+        }
+    }
+
+    // rv32_load_fix over the aligned word
+    static uint32_t load_fix(uint32_t op, uint32_t addr, uint32_t raw) {
+        uint32_t sh = (addr & 3) * 8;
+        switch (op) {
+            case MEM_LW: return raw;
+            case MEM_LB: return static_cast<uint32_t>(static_cast<int8_t>(raw >> sh));
+            case MEM_LBU: return (raw >> sh) & 0xff;
+            case MEM_LH:
+                if (addr & 1) return 0;
+                return static_cast<uint32_t>(static_cast<int16_t>(raw >> sh));
+            case MEM_LHU:
+                if (addr & 1) return 0;
+                return (raw >> sh) & 0xffff;
+            default: return 0;
+        }
+    }
+
+    void set_rd(ISSStep& s, uint32_t rd, uint32_t v) {
+        if (rd == 0) return;
+        x[rd] = v;
+        s.rd_write = true;
+        s.rd = rd;
+        s.rd_value = v;
+    }
+
+    ISSStep step() {
+        ISSStep s;
+        uint32_t i = fetch(pc);
+        s.pc = pc;
+        s.instr = i;
+
+        uint32_t opcode = i & 0x7f;
+        uint32_t rd = (i >> 7) & 31;
+        uint32_t funct3 = (i >> 12) & 7;
+        uint32_t rs1 = (i >> 15) & 31;
+        uint32_t rs2 = (i >> 20) & 31;
+        uint32_t funct7 = i >> 25;
+
+        uint32_t imm_i = static_cast<uint32_t>(static_cast<int32_t>(i) >> 20);
+        uint32_t imm_s = (static_cast<uint32_t>(static_cast<int32_t>(i) >> 25) << 5) |
+            ((i >> 7) & 0x1f);
+        uint32_t imm_b = (static_cast<uint32_t>(static_cast<int32_t>(i) >> 31) << 12) |
+            (((i >> 7) & 1) << 11) | (((i >> 25) & 0x3f) << 5) | (((i >> 8) & 0xf) << 1);
+        uint32_t imm_u = i & 0xfffff000;
+        uint32_t imm_j = (static_cast<uint32_t>(static_cast<int32_t>(i) >> 31) << 20) |
+            (i & 0xff000) | (((i >> 20) & 1) << 11) | (((i >> 21) & 0x3ff) << 1);
+
+        uint32_t a = x[rs1], b = x[rs2];
+        uint32_t next_pc = pc + 4;
+
+        switch (opcode) {
+            case 0b0110111: // LUI
+                set_rd(s, rd, imm_u);
+                break;
+            case 0b0010111: // AUIPC
+                set_rd(s, rd, pc + imm_u);
+                break;
+            case 0b1101111: // JAL
+                set_rd(s, rd, pc + 4);
+                next_pc = pc + imm_j;
+                break;
+            case 0b1100111: // JALR
+                next_pc = a + imm_i;
+                set_rd(s, rd, pc + 4);
+                break;
+            case 0b1100011: // BRANCH
+                if (branch(funct3, a, b)) next_pc = pc + imm_b;
+                break;
+            case 0b0010011: { // INTEGER IMM
+                bool is_srai = funct3 == 0b101 && (funct7 & 0x20);
+                set_rd(s, rd, alu((is_srai << 3) | funct3, a, imm_i));
+                break;
+            }
+            case 0b0110011: // INTEGER REG
+                if (funct7 == 1 && (funct3 & 0b100)) set_rd(s, rd, div(funct3, a, b));
+                else if (funct7 == 1) set_rd(s, rd, mul(funct3, a, b));
+                else set_rd(s, rd, alu((((funct7 >> 5) & 1) << 3) | funct3, a, b));
+                break;
+            case 0b0000011: { // LOAD
+                uint32_t addr = a + imm_i;
+                s.mem_access = true;
+                s.mem_op = funct3;
+                s.mem_addr = addr;
+                uint32_t raw = 0;
+                if (in_memory(addr & ~3u, 4)) raw = fetch(addr);
+                else {
+                    s.external = true;
+                    if (mmio_load) mmio_load(addr, raw);
+                }
+                set_rd(s, rd, load_fix(funct3, addr, raw));
+                break;
+            }
+            case 0b0100011: { // STORE
+                uint32_t op = 0b1000 | funct3;
+                if (op == MEM_NOP) break;
+                uint32_t addr = a + imm_s;
+                s.mem_access = true;
+                s.store = true;
+                s.mem_op = op;
+                s.mem_addr = addr;
+                s.mem_data = b;
+                uint32_t size = op == MEM_SB ? 1 : op == MEM_SH ? 2 : op == MEM_SW ? 4 : 0;
+                if (size == 0) break;
+                if (in_memory(addr, size)) std::memcpy(memory.data() + addr, &b, size);
+                else if (mmio_store) mmio_store(addr, b, op);
+                break;
+            }
+            case 0b1110011: { // ZICSR
+                uint32_t id = i >> 20;
+                uint32_t csr = read_csr(id);
+                uint32_t operand = (funct3 & 0b100) ? rs1 : a;
+                uint32_t result = csr;
+                switch (funct3 & 0b11) {
+                    case 0b01: result = operand; break;
+                    case 0b10: result = csr | operand; break;
+                    case 0b11: result = csr & ~operand; break;
+                    default: break;
+                }
+                if (is_counter_csr(id)) s.external = true;
+                set_rd(s, rd, csr);
+                // csrrs/csrrc with rs1 = x0 (or zero immediate) do not write
+                if ((funct3 & 0b11) == 0b01 || rs1 != 0) {
+                    s.csr_write = true;
+                    s.csr_id = id;
+                    s.csr_value = result;
+                    write_csr(id, result);
+                }
+                break;
+            }
+            case 0b0001011: // GRNG
+                if (funct3 == 0b000) grng.set_seed(a);
+                else if (funct3 == 0b001) set_rd(s, rd, grng.gen());
+                break;
+            default: // fence and invalid instructions
+                break;
+        }
+
+        x[0] = 0;
+        pc = next_pc;
+        instret++;
+        // No timing model, 1 cycle per instruction
+        if (!(mcountinhibit & 0b001)) mcycle++;
+        if (!(mcountinhibit & 0b100)) minstret++;
+        return s;
+    }
+};
+
+}
+
+#endif
@@ -125,14 +125,24 @@ inline void handle_mmio_request(Vrv32_top* rvtop, uint64_t sim_time) {
     rvtop->mmio_request_done[0] = 0;
     mmio_exit_request(rvtop, sim_time);
     mmio_print_request(rvtop);
-    mmio_profiler_request(rvtop, sim_time);
+    mmio_profiler_request(rvtop);
 }
 
 // Store the values for 1 cycle delay serve
 static uint32_t read_instr = 0, read_mem_data = 0;
 static uint32_t instr_wait_cyles = 0, data_wait_cyles = 0;
+// Address and operation of the request being delayed, the wait restarts when
+// the core drops it for another one
+static uint32_t instr_wait_addr = 0, data_wait_addr = 0;
+static uint32_t instr_wait_op = RV32Types::MEM_NOP, data_wait_op = RV32Types::MEM_NOP;
 static bool aux = false;
 
+// Extra cycles every instruction memory request waits, models a memory
+// slower than the BRAM behind the instruction cache
+static uint32_t instr_wait_states = 0;
+// Same for data memory requests, MMIO is not delayed
+static uint32_t data_wait_states = 0;
+
 inline void handle_instruction_request(Vrv32_top* rvtop, rv32_memory& rvmem) {
 
     // Set up values with 1 cycle delay
@@ -144,16 +154,30 @@ inline void handle_instruction_request(Vrv32_top* rvtop, rv32_memory& rvmem) {
     // By default no request is served
     rvtop->rv32_top->instr_request_done = 0;
 
+    // Restart the delay when the pending request changes
+    if (request.addr != instr_wait_addr || request.op != instr_wait_op) {
+        instr_wait_addr = request.addr;
+        instr_wait_op = request.op;
+        instr_wait_cyles = 0;
+    }
+
     // Ignore NOP operations
     if (request.op == RV32Types::MEM_NOP) return;
 
     if (request.addr <= rvmem.max_addr) {
 
+        // Delay control
+        if (instr_wait_cyles < instr_wait_states) {
+            if (rvtop->clk == 1) instr_wait_cyles++;
+            return;
+        }
+
         rvtop->rv32_top->instr_request_done = 1;
 
         // Read instruction
         if (rvtop->clk == 1 && request.op == RV32Types::MEM_LW) {
             read_instr = read_aligned_word(rvmem, request.addr);
+            instr_wait_cyles = 0;
         }
     } else {
         // Out of memory bounds request
@@ -174,20 +198,23 @@ inline void handle_data_request(Vrv32_top* rvtop, rv32_memory& rvmem) {
     // By default no request is served
     rvtop->rv32_top->mem_data_ready = 0;
 
+    // Restart the delay when the pending request changes
+    if (request.addr != data_wait_addr || request.op != data_wait_op) {
+        data_wait_addr = request.addr;
+        data_wait_op = request.op;
+        data_wait_cyles = 0;
+    }
+
     // Ignore NOP operations
     if (request.op == RV32Types::MEM_NOP) return;
 
     if (request.addr <= rvmem.max_addr) {
 
         // Delay control
-        /*
-        if (data_wait_cyles >= 1) {
-            if (rvtop->clk == 1) data_wait_cyles = 0;
-        } else {
+        if (data_wait_cyles < data_wait_states) {
             if (rvtop->clk == 1) data_wait_cyles++;
             return;
         }
-        */
 
         rvtop->rv32_top->mem_data_ready = 1;
 
@@ -195,6 +222,7 @@ inline void handle_data_request(Vrv32_top* rvtop, rv32_memory& rvmem) {
         if (rvtop->clk == 1) {
 
             read_mem_data = read_aligned_word(rvmem, request.addr);
+            data_wait_cyles = 0;
 
             switch(request.op) {
                 case RV32Types::MEM_SB:
@@ -1,7 +1,12 @@
 #ifndef RV32_MMIO_PROFILER
 #define RV32_MMIO_PROFILER
 
+#include <algorithm>
 #include <iostream>
+#include <format>
+#include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "rv32_test_utils.h"
 
@@ -9,43 +14,291 @@
 
 namespace rv32_test {
 
-constexpr uint32_t NUM_MMIO_PROFILER_COUNTERS = 255;
+// MMIO profiler device
+// BASE + 0  SB  start region, 8 bit id
+// BASE + 1  SB  stop region, 8 bit id
+// BASE + 4  SH  start region, 16 bit id
+// BASE + 8  SH  stop region, 16 bit id
+// BASE + 12 SH  region id of the name being registered
+// BASE + 16 SB  next character of the name, 0 ends it
+//
+// Starts are pushed in a stack and stops pop the last start of the same id
+// so nested and recursive regions are measured correctly
+// Cycles and instructions are inclusive of the nested regions
 
-static uint64_t profiler_counters[NUM_MMIO_PROFILER_COUNTERS];
-static uint64_t profiler_counters_starts[NUM_MMIO_PROFILER_COUNTERS];
+struct ProfilerRegion {
+    std::string name = "";
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+    uint64_t min_cycles = UINT64_MAX;
+    uint64_t max_cycles = 0;
+    uint64_t instructions = 0;
+    // Cycles above one per retired instruction, not only stalls but also
+    // flushes and multi-cycle units
+    uint64_t extra_cycles = 0;
+
+    double mean_cycles() const {
+        return calls ? static_cast<double>(cycles) / calls : 0;
+    }
+};
+
+struct ProfilerFrame {
+    uint32_t id;
+    uint64_t cycle;
+    uint64_t instret;
+};
+
+static std::map<uint32_t, ProfilerRegion> profiler_regions;
+static std::vector<ProfilerFrame> profiler_stack;
+static uint32_t profiler_name_id = 0;
+static std::string profiler_name_buffer = "";
+static std::string profiler_json_file = "";
+
+// Timeline of start/stop events, only recorded if an output file is set
+struct ProfilerEvent {
+    uint64_t cycle;
+    uint32_t id;
+    bool start;
+};
+
+static std::vector<ProfilerEvent> profiler_events;
+static std::string profiler_timeline_file = "";
+
+// Number of start/stop events
+static uint64_t profiler_num_events = 0;
 
 inline void init_profiler_counters() {
-    std::memset(profiler_counters, 0, NUM_MMIO_PROFILER_COUNTERS * sizeof(uint64_t));
+    profiler_regions.clear();
+    profiler_stack.clear();
+}
+
+inline void init_profiler_json(const std::string filename) {
+    profiler_json_file = filename;
 }
 
 inline void print_profiler_counters() {
-    for(size_t i = 0; i < NUM_MMIO_PROFILER_COUNTERS; i++) {
-        if (profiler_counters[i] == 0) continue; // Ignore unused counters
-        std::cout << "Counter " << i << " " << profiler_counters[i] << '\n';
+    for (auto& [id, r] : profiler_regions) {
+        if (r.calls == 0) continue; // Ignore unused counters
+        std::cout << std::format(
+            "Counter {} {} calls {} min {} max {} mean {:.2f} instr {} extra {}{}\n",
+            id, r.cycles, r.calls, r.min_cycles, r.max_cycles, r.mean_cycles(),
+            r.instructions, r.extra_cycles, r.name == "" ? "" : " " + r.name);
     }
 }
 
-inline void mmio_profiler_request(Vrv32_top* rvtop, uint64_t sim_time) {
-    MemoryRequest request = get_memory_request(rvtop);
-    // Start
-    if (request.addr == PROFILER_BASE_ADDR) {
-        rvtop->mmio_request_done[0] = 1; // Tell the core the request is done
-        if (rvtop->clk == 1 && request.op == RV32Types::MEM_SB) {
-            uint8_t counter_id = static_cast<uint8_t>(request.data);
-            profiler_counters_starts[counter_id] = sim_time;
-        }
-        
-    }
-    // Stop
-    if (request.addr == (PROFILER_BASE_ADDR + 1)) {
-        rvtop->mmio_request_done[0] = 1; // Tell the core the request is done
-        if (rvtop->clk == 1 && request.op == RV32Types::MEM_SB) {
-            uint8_t counter_id = static_cast<uint8_t>(request.data);
-            profiler_counters[counter_id] += (sim_time - profiler_counters_starts[counter_id]) / 2;
+// Region names file, one "id;name" entry per line
+// Names registered by the program through MMIO take precedence
+inline void load_profiler_region_names(const std::string filename) {
+    std::stringstream ss;
+    std::string line = "", id_token = "", name_token = "";
+
+    std::ifstream f = std::ifstream(filename);
+    if (!f.is_open()) return;
+
+    while(!f.eof()) {
+        getline(f, line);
+        if (line == "") continue; // Guard for empty lines
+        ss.clear();
+        ss << line;
+        getline(ss, id_token, ';');
+        getline(ss, name_token, ';');
+        profiler_regions[std::stoi(id_token)].name = name_token;
+    }
+}
+
+inline void init_profiler_timeline(const std::string filename) {
+    profiler_timeline_file = filename;
+}
+
+inline std::string profiler_region_name(uint32_t id) {
+    auto it = profiler_regions.find(id);
+    if (it != profiler_regions.end() && it->second.name != "") return it->second.name;
+    return "Counter " + std::to_string(id);
+}
+
+// Open regions, outermost first, "id|id|..."
+inline std::string profiler_active_regions() {
+    std::string s = "";
+    for (const ProfilerFrame& fr : profiler_stack) {
+        if (s != "") s += "|";
+        s += std::to_string(fr.id);
+    }
+    return s;
+}
+
+inline void record_profiler_event(uint32_t id, bool start, uint64_t cycle) {
+    profiler_num_events++;
+    if (profiler_timeline_file == "") return;
+    profiler_events.push_back({cycle, id, start});
+}
+
+inline void profiler_start(uint32_t id) {
+    uint64_t cycle = retire_monitor.cycles;
+    profiler_stack.push_back({id, cycle, retire_monitor.instret});
+    record_profiler_event(id, true, cycle);
+}
+
+inline void profiler_stop(uint32_t id) {
+    uint64_t cycle = retire_monitor.cycles;
+
+    auto it = std::find_if(profiler_stack.rbegin(), profiler_stack.rend(),
+        [id](const ProfilerFrame& fr) { return fr.id == id; });
+    // Stop without start, ignore it
+    if (it == profiler_stack.rend()) return;
+
+    uint64_t cycles = cycle - it->cycle;
+    uint64_t instructions = retire_monitor.instret - it->instret;
+
+    ProfilerRegion& r = profiler_regions[id];
+    r.calls++;
+    r.cycles += cycles;
+    r.min_cycles = std::min(r.min_cycles, cycles);
+    r.max_cycles = std::max(r.max_cycles, cycles);
+    r.instructions += instructions;
+    r.extra_cycles += cycles - instructions;
+
+    profiler_stack.erase(std::next(it).base());
+    record_profiler_event(id, false, cycle);
+}
+
+inline std::string json_escape(const std::string& s) {
+    std::string r = "";
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        if (static_cast<uint8_t>(c) < 0x20) continue;
+        r += c;
+    }
+    return r;
+}
+
+inline void write_profiler_json() {
+    if (profiler_json_file == "") return;
+
+    std::ofstream f(profiler_json_file);
+    if (!f.is_open()) {
+        std::cerr << "Cannot open profiler file " << profiler_json_file << '\n';
+        return;
+    }
+
+    f << "{\"regions\": [";
+    bool first = true;
+    for (auto& [id, r] : profiler_regions) {
+        if (r.calls == 0) continue;
+        f << (first ? "\n" : ",\n");
+        first = false;
+        f << std::format(
+            "  {{\"id\": {}, \"name\": \"{}\", \"calls\": {}, \"cycles\": {}, "
+            "\"min\": {}, \"max\": {}, \"mean\": {:.2f}, "
+            "\"instructions\": {}, \"extra_cycles\": {}}}",
+            id, json_escape(profiler_region_name(id)), r.calls, r.cycles,
+            r.min_cycles, r.max_cycles, r.mean_cycles(),
+            r.instructions, r.extra_cycles);
+    }
+    f << "\n]}\n";
+}
+
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)
+// Timestamps are core cycles reported as microseconds
+// Every start/stop pair becomes a complete "X" event, starts of the
+// same id are stacked so recursive and nested regions are matched
+inline void write_profiler_timeline() {
+    if (profiler_timeline_file == "") return;
+
+    std::ofstream f(profiler_timeline_file);
+    if (!f.is_open()) {
+        std::cerr << "Cannot open timeline file " << profiler_timeline_file << '\n';
+        return;
+    }
+
+    std::unordered_map<uint32_t, std::vector<uint64_t>> open_regions;
+    uint64_t last_cycle = 0;
+    bool first = true;
+
+    auto write_event = [&](uint32_t id, uint64_t begin, uint64_t end, bool closed) {
+        f << (first ? "\n" : ",\n");
+        first = false;
+        f << std::format(
+            "{{\"name\":\"{}\",\"cat\":\"profiler\",\"ph\":\"X\","
+            "\"ts\":{},\"dur\":{},\"pid\":0,\"tid\":0,"
+            "\"args\":{{\"id\":{},\"closed\":{}}}}}",
+            json_escape(profiler_region_name(id)), begin, end - begin,
+            id, closed ? "true" : "false");
+    };
+
+    f << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for (const ProfilerEvent& e : profiler_events) {
+        last_cycle = e.cycle;
+        if (e.start) {
+            open_regions[e.id].push_back(e.cycle);
+            continue;
         }
+        auto it = open_regions.find(e.id);
+        // Stop without start, ignore it
+        if (it == open_regions.end() || it->second.empty()) continue;
+        write_event(e.id, it->second.back(), e.cycle, true);
+        it->second.pop_back();
+    }
+
+    // Regions still open at exit end at the last recorded event
+    for (auto& [id, starts] : open_regions) {
+        for (uint64_t start : starts) write_event(id, start, last_cycle, false);
     }
+
+    f << "\n]}\n";
+}
+
+// Store to the profiler registers, also used by the fast-forward ISS
+inline void profiler_store(uint32_t addr, uint32_t op, uint32_t data) {
+    bool byte_store = op == RV32Types::MEM_SB;
+    bool id_store = op == RV32Types::MEM_SH || op == RV32Types::MEM_SW;
+
+    switch (addr - PROFILER_BASE_ADDR) {
+        case 0:
+            if (byte_store) profiler_start(static_cast<uint8_t>(data));
+            break;
+        case 1:
+            if (byte_store) profiler_stop(static_cast<uint8_t>(data));
+            break;
+        case 4:
+            if (id_store) profiler_start(static_cast<uint16_t>(data));
+            break;
+        case 8:
+            if (id_store) profiler_stop(static_cast<uint16_t>(data));
+            break;
+        case 12:
+            if (id_store) {
+                profiler_name_id = static_cast<uint16_t>(data);
+                profiler_name_buffer = "";
+            }
+            break;
+        case 16:
+            if (!byte_store) break;
+            if (static_cast<uint8_t>(data) == 0) {
+                profiler_regions[profiler_name_id].name = profiler_name_buffer;
+                profiler_name_buffer = "";
+            } else {
+                profiler_name_buffer += static_cast<char>(data);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+inline void mmio_profiler_request(Vrv32_top* rvtop) {
+    MemoryRequest request = get_memory_request(rvtop);
+
+    if (request.addr < PROFILER_BASE_ADDR ||
+        request.addr > PROFILER_BASE_ADDR + 16) return;
+
+    rvtop->mmio_request_done[0] = 1; // Tell the core the request is done
+
+    // Only stores on rising edge
+    if (rvtop->clk != 1) return;
+    profiler_store(request.addr, request.op, request.data);
 }
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,93 @@
+#ifndef RV32_PC_SAMPLER
+#define RV32_PC_SAMPLER
+
+#include <algorithm>
+#include <iostream>
+#include <format>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_elf_symbols.h"
+
+namespace rv32_test {
+
+// Statistical PC sampler, no guest instrumentation
+// Every period cycles the PC of the oldest instruction in flight is sampled
+// Period 1 attributes every cycle
+static uint64_t sampler_period = 0;
+static std::string sampler_output = "";
+static uint64_t sampler_total = 0;
+static std::unordered_map<uint32_t, uint64_t> pc_samples;
+
+inline void init_pc_sampler(uint64_t period, const std::string output) {
+    sampler_period = period;
+    sampler_output = output;
+}
+
+inline void pc_sampler_cycle(
+    const Vrv32_top* rvtop, const RetireMonitor& rm, uint64_t cycle) {
+
+    if (sampler_period == 0 || cycle % sampler_period != 0) return;
+    pc_samples[get_oldest_pc(rvtop, rm)]++;
+    sampler_total++;
+}
+
+// Writes output.txt with the flat profile and the annotated listing
+// and output.folded with one line per function for flame graph tools
+inline void write_pc_profile(const SymbolTable& symbols, const DissasemblyMap& dmap) {
+    if (sampler_period == 0 || sampler_total == 0) return;
+
+    std::ofstream f(sampler_output + ".txt");
+    std::ofstream ff(sampler_output + ".folded");
+    if (!f.is_open() || !ff.is_open()) {
+        std::cerr << "Cannot open pc profile output " << sampler_output << '\n';
+        return;
+    }
+
+    // Group samples by function, instructions sorted by pc
+    std::map<std::string, std::map<uint32_t, uint64_t>> functions;
+    std::map<std::string, uint64_t> function_samples;
+    for (auto& [pc, n] : pc_samples) {
+        std::string name = symbols.name(pc);
+        functions[name][pc] = n;
+        function_samples[name] += n;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> flat(
+        function_samples.begin(), function_samples.end());
+    std::sort(flat.begin(), flat.end(),
+        [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    auto pct = [](uint64_t n) {
+        return 100.0 * static_cast<double>(n) / static_cast<double>(sampler_total);
+    };
+
+    f << std::format("Flat profile, {} samples every {} cycles\n\n",
+        sampler_total, sampler_period);
+    f << std::format("{:>8} {:>12} {:>14}  {}\n", "%", "samples", "cycles", "function");
+    for (auto& [name, n] : flat) {
+        f << std::format("{:>8.2f} {:>12} {:>14}  {}\n",
+            pct(n), n, n * sampler_period, name);
+        ff << name << ' ' << n * sampler_period << '\n';
+    }
+
+    f << "\nAnnotated listing\n";
+    for (auto& [name, n] : flat) {
+        f << std::format("\n{} ({:.2f}%)\n", name, pct(n));
+        for (auto& [pc, pc_n] : functions[name]) {
+            std::string asm_str = "";
+            auto it = dmap.find(pc);
+            if (it != dmap.end()) asm_str = it->second;
+            f << std::format("{:>8.2f} {:>12}  {:>#10x}: {}\n",
+                pct(pc_n), pc_n, pc, asm_str);
+        }
+    }
+
+    std::cout << "PC profile written to " << sampler_output << ".txt\n";
+}
+
+}
+
+#endif
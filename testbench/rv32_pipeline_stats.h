@@ -0,0 +1,346 @@
+#ifndef RV32_PIPELINE_STATS
+#define RV32_PIPELINE_STATS
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <format>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_elf_symbols.h"
+
+namespace rv32_test {
+
+// Cycle accounting of the pipeline
+// Every cycle is assigned to exactly 1 category of the CPI stack
+// A cycle retires an instruction or the writeback stage holds a bubble or
+// a stale instruction, bubbles are tagged with the cause that created them
+// and the tags move through the pipeline like the real instructions
+enum CycleCategory {
+    CYCLE_RETIRE,
+    CYCLE_MEM_STALL,
+    CYCLE_FETCH_STALL,
+    CYCLE_LOAD_USE,
+    CYCLE_MUL_USE,
+    CYCLE_FLUSH,
+    CYCLE_EXEC_STALL,
+    CYCLE_STARTUP,
+    NUM_CYCLE_CATEGORIES
+};
+
+inline std::string cycle_category_str(uint32_t c) {
+    static const std::array<std::string, NUM_CYCLE_CATEGORIES> str = {
+        "retire", "mem_stall", "fetch_stall", "load_use", "mul_use",
+        "branch_flush", "exec_stall", "startup"
+    };
+    return str[c];
+}
+
+class PipelineStats {
+  public:
+    bool enabled = false;
+    bool print_text = false;
+    std::string json_output = "";
+
+    // CPI stack
+    std::array<uint64_t, NUM_CYCLE_CATEGORIES> cycles = {};
+    uint64_t total_cycles = 0;
+
+    // Raw event counts, cycles with the signal active
+    uint64_t load_use_stall_cycles = 0;
+    uint64_t mul_use_stall_cycles = 0;
+    uint64_t mem_stall_cycles = 0;
+    uint64_t fetch_stall_cycles = 0;
+    // Multi-cycle exec units
+    uint64_t exec_stall_cycles = 0;
+    // Exec redirects, mispredicted branches/jumps
+    uint64_t jumps = 0;
+    // Decode redirects of unconditional jumps
+    uint64_t decode_jumps = 0;
+
+    // Branch predictor counters, branches/jumps resolved in exec
+    uint64_t predictor_hits = 0;
+    uint64_t predictor_misses = 0;
+
+    // Instruction cache counters
+    uint64_t icache_hits = 0;
+    uint64_t icache_misses = 0;
+
+    // Data cache counters
+    uint64_t dcache_hits = 0;
+    uint64_t dcache_misses = 0;
+    uint64_t dcache_writebacks = 0;
+
+    // Operands bypassed when instructions move from decode to exec
+    uint64_t bypass_exec = 0;
+    uint64_t bypass_mem = 0;
+    // CSR values bypassed from an older CSR write
+    uint64_t bypass_csr = 0;
+
+    // Bubble tags of decode, exec, mem and writeback
+    // The tag keeps the pc of the instruction that caused the bubble and,
+    // for data hazards, the pc of the producer instruction
+    static constexpr uint32_t NO_PRODUCER = 0xffffffff;
+    struct BubbleTag {
+        uint32_t category = CYCLE_STARTUP;
+        uint32_t pc = 0;
+        uint32_t producer_pc = NO_PRODUCER;
+    };
+    enum { DEC, EXEC, MEM, WB };
+    std::array<BubbleTag, 4> tag;
+
+    // Lost cycles by (category, pc, producer pc)
+    bool hotspots_enabled = false;
+    std::string hotspots_output = "";
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint64_t> hotspots;
+
+    void init(bool text, const std::string json) {
+        enabled = true;
+        print_text = text;
+        json_output = json;
+    }
+
+    void init_hotspots(const std::string output) {
+        enabled = true;
+        hotspots_enabled = true;
+        hotspots_output = output;
+    }
+
+    uint64_t retired() const { return cycles[CYCLE_RETIRE]; }
+
+    void cycle(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+        if (!enabled) return;
+
+        bool mem_stall = get_memory_stall(rvtop);
+        bool dec_stall = get_decode_stall(rvtop);
+        bool load_use = get_load_use_stall(rvtop);
+        bool mul_use = get_mul_use_stall(rvtop);
+        bool jump = get_exec_jump(rvtop);
+        // Exec redirect of an older instruction wins
+        bool decode_jump = get_decode_jump(rvtop) && !jump;
+        bool fetch_stall = get_fetch_stall(rvtop);
+        bool exec_stall = get_exec_stall(rvtop);
+
+        auto decode_data = get_decode_stage_data(rvtop);
+        auto exec_data = get_exec_stage_data(rvtop);
+        auto mem_data = get_mem_stage_data(rvtop);
+
+        // Classify this cycle
+        BubbleTag c;
+        if (rm.retired) c.category = CYCLE_RETIRE;
+        else if (rm.stale) {
+            // The stalling instruction is still at mem
+            c.category = CYCLE_MEM_STALL;
+            c.pc = mem_data.pc;
+        }
+        else c = tag[WB];
+        cycles[c.category]++;
+        total_cycles++;
+
+        if (hotspots_enabled && c.category != CYCLE_RETIRE) {
+            hotspots[{c.category, c.pc, c.producer_pc}]++;
+        }
+
+        load_use_stall_cycles += load_use;
+        mul_use_stall_cycles += mul_use && !load_use;
+        mem_stall_cycles += mem_stall;
+        fetch_stall_cycles += fetch_stall;
+        exec_stall_cycles += exec_stall && !mem_stall;
+        // A jump held in exec by a memory stall is counted once
+        jumps += jump && !mem_stall;
+        decode_jumps += decode_jump;
+        predictor_hits = get_branch_predictor_hits(rvtop);
+        predictor_misses = get_branch_predictor_misses(rvtop);
+        icache_hits = get_icache_hits(rvtop);
+        icache_misses = get_icache_misses(rvtop);
+        dcache_hits = get_dcache_hits(rvtop);
+        dcache_misses = get_dcache_misses(rvtop);
+        dcache_writebacks = get_dcache_writebacks(rvtop);
+
+        // Bypass usage of the instruction leaving decode
+        if (!mem_stall && !exec_stall && !dec_stall && !jump &&
+            decode_data.valid) {
+            for (uint32_t i = 0; i < 3; i++) {
+                auto b = static_cast<RV32Types::bypass_t>(decode_data.control.bypass_rs[i]);
+                if (b == RV32Types::BYPASS_EXEC_BUFF) bypass_exec++;
+                else if (b == RV32Types::BYPASS_MEM_BUFF) bypass_mem++;
+            }
+            bypass_csr += decode_data.control.bypass_csr != RV32Types::NO_BYPASS;
+        }
+
+        // Move the tags as the pipeline buffers do on the next clk edge
+        BubbleTag flush = {CYCLE_FLUSH, exec_data.pc, NO_PRODUCER};
+
+        // Only fetch/decode buffer is flushed during a memory stall
+        if (mem_stall) {
+            if (jump) tag[DEC] = flush;
+            return;
+        }
+        tag[WB] = tag[MEM];
+        // Exec sends a bubble to mem, decode and exec hold
+        if (exec_stall) {
+            tag[MEM] = {CYCLE_EXEC_STALL, exec_data.pc, NO_PRODUCER};
+            return;
+        }
+        tag[MEM] = tag[EXEC];
+        if (jump) tag[EXEC] = flush;
+        else if (dec_stall) {
+            tag[EXEC].pc = decode_data.pc;
+            if (load_use) {
+                // Producer is the load at exec
+                tag[EXEC].category = CYCLE_LOAD_USE;
+                tag[EXEC].producer_pc = exec_data.pc;
+            } else {
+                // Producer is the pipelined MUL at exec
+                tag[EXEC].category = CYCLE_MUL_USE;
+                tag[EXEC].producer_pc = exec_data.pc;
+            }
+        }
+        else tag[EXEC] = tag[DEC];
+
+        if (jump) tag[DEC] = flush;
+        else if (dec_stall) return;
+        else if (decode_jump) tag[DEC] = {CYCLE_FLUSH, decode_data.pc, NO_PRODUCER};
+        else if (fetch_stall) {
+            tag[DEC] = {CYCLE_FETCH_STALL, get_fetch_request(rvtop).addr, NO_PRODUCER};
+        }
+        else tag[DEC] = {CYCLE_RETIRE, 0, NO_PRODUCER}; // Valid instruction
+    }
+
+    double ipc() const {
+        if (total_cycles == 0) return 0;
+        return static_cast<double>(retired()) / total_cycles;
+    }
+
+    double cpi(uint32_t c) const {
+        if (retired() == 0) return 0;
+        return static_cast<double>(cycles[c]) / retired();
+    }
+
+    void print() const {
+        if (!enabled || !print_text) return;
+
+        std::cout << std::format("\nCycles {} Instructions {} IPC {:.4f} CPI {:.4f}\n",
+            total_cycles, retired(), ipc(),
+            retired() ? static_cast<double>(total_cycles) / retired() : 0);
+
+        std::cout << std::format("{:<20} {:>14} {:>8} {:>8}\n",
+            "CPI stack", "cycles", "%", "CPI");
+        for (uint32_t c = 0; c < NUM_CYCLE_CATEGORIES; c++) {
+            std::cout << std::format("{:<20} {:>14} {:>8.2f} {:>8.4f}\n",
+                cycle_category_str(c), cycles[c],
+                total_cycles ? 100.0 * cycles[c] / total_cycles : 0, cpi(c));
+        }
+
+        std::cout << std::format("Load use stall cycles {}\n", load_use_stall_cycles);
+        std::cout << std::format("MUL use stall cycles {}\n", mul_use_stall_cycles);
+        std::cout << std::format("Memory stall cycles {}\n", mem_stall_cycles);
+        std::cout << std::format("Fetch stall cycles {}\n", fetch_stall_cycles);
+        std::cout << std::format("Exec stall cycles {}\n", exec_stall_cycles);
+        std::cout << std::format("Branch redirects exec {} decode {}\n", jumps, decode_jumps);
+        uint64_t predicted = predictor_hits + predictor_misses;
+        std::cout << std::format("Branch predictor hits {} misses {} accuracy {:.2f}%\n",
+            predictor_hits, predictor_misses,
+            predicted ? 100.0 * predictor_hits / predicted : 0);
+        uint64_t fetches = icache_hits + icache_misses;
+        if (fetches != 0) {
+            std::cout << std::format("Instruction cache hits {} misses {} hit rate {:.2f}%\n",
+                icache_hits, icache_misses, 100.0 * icache_hits / fetches);
+        }
+        uint64_t accesses = dcache_hits + dcache_misses;
+        if (accesses != 0) {
+            std::cout << std::format("Data cache hits {} misses {} writebacks {} hit rate {:.2f}%\n",
+                dcache_hits, dcache_misses, dcache_writebacks, 100.0 * dcache_hits / accesses);
+        }
+        std::cout << std::format("Bypass exec {} mem {} csr {}\n", bypass_exec, bypass_mem, bypass_csr);
+    }
+
+    void write_json() const {
+        if (!enabled || json_output == "") return;
+
+        std::ofstream f(json_output);
+        if (!f.is_open()) {
+            std::cerr << "Cannot open stats file " << json_output << '\n';
+            return;
+        }
+
+        f << "{\n";
+        f << std::format("  \"cycles\": {},\n", total_cycles);
+        f << std::format("  \"instructions\": {},\n", retired());
+        f << std::format("  \"ipc\": {:.6f},\n", ipc());
+        f << "  \"cpi_stack\": {";
+        for (uint32_t c = 0; c < NUM_CYCLE_CATEGORIES; c++) {
+            f << std::format("{}\n    \"{}\": {{\"cycles\": {}, \"cpi\": {:.6f}}}",
+                c ? "," : "", cycle_category_str(c), cycles[c], cpi(c));
+        }
+        f << "\n  },\n";
+        f << "  \"events\": {\n";
+        f << std::format("    \"load_use_stall_cycles\": {},\n", load_use_stall_cycles);
+        f << std::format("    \"mul_use_stall_cycles\": {},\n", mul_use_stall_cycles);
+        f << std::format("    \"mem_stall_cycles\": {},\n", mem_stall_cycles);
+        f << std::format("    \"fetch_stall_cycles\": {},\n", fetch_stall_cycles);
+        f << std::format("    \"exec_stall_cycles\": {},\n", exec_stall_cycles);
+        f << std::format("    \"jumps\": {},\n", jumps);
+        f << std::format("    \"decode_jumps\": {},\n", decode_jumps);
+        f << std::format("    \"predictor_hits\": {},\n", predictor_hits);
+        f << std::format("    \"predictor_misses\": {},\n", predictor_misses);
+        f << std::format("    \"icache_hits\": {},\n", icache_hits);
+        f << std::format("    \"icache_misses\": {},\n", icache_misses);
+        f << std::format("    \"dcache_hits\": {},\n", dcache_hits);
+        f << std::format("    \"dcache_misses\": {},\n", dcache_misses);
+        f << std::format("    \"dcache_writebacks\": {},\n", dcache_writebacks);
+        f << std::format("    \"bypass_exec\": {},\n", bypass_exec);
+        f << std::format("    \"bypass_mem\": {},\n", bypass_mem);
+        f << std::format("    \"bypass_csr\": {}\n", bypass_csr);
+        f << "  }\n}\n";
+    }
+
+    // Ranked list of the instructions (and producers) that lose most cycles
+    void write_hotspots(const SymbolTable& symbols, const DissasemblyMap& dmap) const {
+        if (!hotspots_enabled) return;
+
+        std::ofstream f(hotspots_output);
+        if (!f.is_open()) {
+            std::cerr << "Cannot open hotspot report " << hotspots_output << '\n';
+            return;
+        }
+
+        auto asm_str = [&](uint32_t pc) {
+            auto it = dmap.find(pc);
+            if (it == dmap.end()) return std::string("???");
+            return it->second;
+        };
+
+        std::vector<std::pair<std::tuple<uint32_t, uint32_t, uint32_t>, uint64_t>> ranked(
+            hotspots.begin(), hotspots.end());
+        std::sort(ranked.begin(), ranked.end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        uint64_t lost = total_cycles - retired();
+        f << std::format("Hazard hotspots, {} lost cycles of {}\n\n", lost, total_cycles);
+        f << std::format("{:>12} {:>7}  {:<18} {}\n", "cycles", "%", "cause", "instruction");
+
+        for (auto& [key, n] : ranked) {
+            auto [category, pc, producer_pc] = key;
+            f << std::format("{:>12} {:>7.2f}  {:<18} {:#010x} {:<32} {}\n",
+                n, lost ? 100.0 * n / lost : 0, cycle_category_str(category),
+                pc, symbols.location(pc), asm_str(pc));
+            if (producer_pc != NO_PRODUCER) {
+                f << std::format("{:>12} {:>7}  {:<18} {:#010x} {:<32} {}\n",
+                    "", "", "  producer", producer_pc,
+                    symbols.location(producer_pc), asm_str(producer_pc));
+            }
+        }
+
+        std::cout << "Hazard hotspots written to " << hotspots_output << '\n';
+    }
+};
+
+static PipelineStats pipeline_stats;
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef RV32_SAMPLING
+#define RV32_SAMPLING
+
+#include <cmath>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "rv32_test_utils.h"
+#include "rv32_memory_utils.h"
+#include "rv32_fast_forward.h"
+#include "rv32_iss.h"
+
+namespace rv32_test {
+
+// Sampled simulation, the ISS runs the whole program and the RTL only
+// short samples of it, at regular or random points of every period:
+//   ISS fast-forward | RTL warm-up + measured window | ISS ...
+// Each sample boots a new RTL model from the ISS state (see FastForward),
+// runs W instructions of warm-up and measures the cycles of the next M.
+// The ISS then replays the sampled instructions without output, so it
+// stays the reference of the architectural state
+// The CPI estimate is the mean of the sample CPIs with a 95% confidence
+// interval (Student t), total cycles are extrapolated to the instruction
+// count of the ISS
+class SampledSimulation {
+  public:
+    bool enabled = false;
+    RV32ISS iss;
+
+    uint64_t period = 0;
+    uint64_t warmup = 1000;
+    uint64_t measure = 1000;
+    bool random = false;
+    std::mt19937_64 rng;
+
+    std::vector<double> cpi;
+    // The ISS repeats a sampled window
+    bool replaying = false;
+    // Instructions retired by the RTL in the current sample
+    uint64_t sample_instret = 0;
+
+    // Stop the RTL if a sample makes no progress
+    static constexpr uint64_t MAX_SAMPLE_CPI = 1000;
+
+    [[noreturn]] void run(const rv32_memory& rvmem) {
+        enabled = true;
+        if (period < warmup + measure) {
+            std::cerr << "Sample period smaller than warm-up + measure\n";
+            std::exit(255);
+        }
+
+        iss.init(rvmem.memory.get(), rvmem.max_addr);
+        iss.mmio_store = [this](uint32_t addr, uint32_t data, uint32_t op) {
+            // The RTL already printed the sampled window
+            if (replaying && addr == PRINT_REG_ADDR) return;
+            iss_mmio_store(addr, data, op);
+        };
+
+        for (uint64_t k = 1; ; k++) {
+            uint64_t start = k * period;
+            if (random) start += rng() % (period - warmup - measure + 1);
+
+            // Exit of the program is handled by the ISS MMIO store
+            while (iss.instret < start) iss.step();
+
+            cpi.push_back(run_sample());
+
+            replaying = true;
+            uint64_t end = iss.instret + warmup + measure;
+            while (iss.instret < end) iss.step();
+            replaying = false;
+        }
+    }
+
+    // CPI of the measured window of a RTL run from the current ISS state
+    double run_sample() {
+        FastForward ff;
+        ff.enabled = true;
+        ff.iss = iss;
+        rv32_memory m = ff.build_image();
+
+        Vrv32_top* dut = new Vrv32_top;
+        RetireMonitor& rm = retire_monitor;
+        rm = RetireMonitor();
+
+        uint64_t max_cycles = (warmup + measure) * MAX_SAMPLE_CPI + 1000;
+        uint64_t measure_start = 0;
+        uint64_t sim_time = 0;
+        sample_instret = 0;
+
+        while (true) {
+            dut->clk ^= 1;
+
+            bool reset_on = sim_time <= 4;
+            dut->resetn = static_cast<uint8_t>(!reset_on);
+            if (sim_time == 5) set_memory_banks(dut, m);
+            if (!reset_on) handle_memory_request(dut, m, sim_time);
+
+            dut->eval();
+
+            if (!reset_on && dut->clk == 0) {
+                rm.update(dut);
+                if (!ff.restoring(dut, rm)) {
+                    sample_instret = rm.instret;
+                    if (rm.retired && rm.instret == warmup) measure_start = rm.cycles;
+                    if (rm.instret >= warmup + measure) break;
+                } else if (warmup == 0 && ff.restored) {
+                    // Without warm-up the window starts once the state is restored
+                    measure_start = rm.cycles;
+                }
+                if (rm.cycles > max_cycles) {
+                    std::cerr << std::format("Sample at instruction {} stuck\n", iss.instret);
+                    std::exit(255);
+                }
+            }
+            sim_time++;
+        }
+
+        uint64_t cycles = rm.cycles - measure_start;
+        delete dut;
+        sample_instret = 0;
+        return static_cast<double>(cycles) / static_cast<double>(measure);
+    }
+
+    // Two sided 95% quantile of the t distribution
+    static double t_95(size_t df) {
+        static const double t[30] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        if (df == 0) return 0;
+        if (df <= 30) return t[df - 1];
+        return 1.960;
+    }
+
+    void print() {
+        if (!enabled) return;
+
+        uint64_t instructions = iss.instret + sample_instret;
+        size_t n = cpi.size();
+
+        std::cout << "\nSampled simulation\n";
+        std::cout << std::format("  {:<14}{}\n", "Instructions", instructions);
+        std::cout << std::format("  {:<14}{} (warm-up {}, measured {} instructions, {} period {})\n",
+            "Samples", n, warmup, measure, random ? "random in" : "every", period);
+        if (n == 0) return;
+
+        double mean = 0;
+        for (double c : cpi) mean += c;
+        mean /= n;
+        double var = 0;
+        for (double c : cpi) var += (c - mean) * (c - mean);
+        double sd = n > 1 ? std::sqrt(var / (n - 1)) : 0;
+        double half = t_95(n - 1) * sd / std::sqrt(static_cast<double>(n));
+
+        std::cout << std::format("  {:<14}{:.4f} +- {:.4f} (95% CI)\n", "CPI", mean, half);
+        std::cout << std::format("  {:<14}{:.0f} +- {:.0f} (95% CI)\n", "Cycles",
+            mean * instructions, half * instructions);
+        if (n > 1 && mean > 0) {
+            // Samples needed for +-3% at 99.7% confidence
+            double cov = sd / mean;
+            double needed = std::ceil(std::pow(3.0 * cov / 0.03, 2));
+            std::cout << std::format("  {:<14}{:.3f}, {:.0f} samples for +-3% at 99.7%\n",
+                "CPI CoV", cov, needed);
+        }
+    }
+};
+
+static SampledSimulation sampled_simulation;
+
+}
+
+#endif
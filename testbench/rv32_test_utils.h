@@ -19,6 +19,9 @@
 #include "Vrv32_top_rv32_decode_stage.h"
 #include "Vrv32_top_rv32_exec_stage.h"
 #include "Vrv32_top_rv32_mem_stage.h"
+#include "Vrv32_top_rv32_branch_predictor.h"
+#include "Vrv32_top_rv32_icache.h"
+#include "Vrv32_top_rv32_dcache.h"
 
 #ifndef CPP_MEMORY_SIM
 #include "Vrv32_top_rv32_main_memory.h"
@@ -35,6 +38,7 @@ using WritebackStageData = MemoryStageData;
 using MemoryRequest = Vrv32_top_memory_request_t__struct__0;
 
 using RegisterFileWriteRequest = Vrv32_top_register_write_request_t__struct__0;
+using CSRWriteRequest = Vrv32_top_csr_write_request_t__struct__0;
 
 using Instruction = Vrv32_top_rv_instr_t__struct__0;
 using CoreControlSignals = Vrv32_top_rv_control_t__struct__0;
@@ -71,6 +75,12 @@ inline uint32_t get_wb_result_data(const Vrv32_top* rvtop) {
     return rfwr.data;
 }
 
+inline CSRWriteRequest get_csr_write_request(const Vrv32_top* rvtop) {
+    CSRWriteRequest csrwr;
+    csrwr.set(rvtop->rv32_top->core->csr_write_request);
+    return csrwr;
+}
+
 inline uint32_t get_next_pc(const Vrv32_top* rvtop) {
     return rvtop->rv32_top->core->next_pc;
 }
@@ -85,6 +95,22 @@ inline uint32_t get_instruction_response(const Vrv32_top* rvtop) {
     return rvtop->rv32_top->instr;
 }
 
+// Request of the fetch stage, the instruction request above is the one of
+// the instruction cache when it is enabled
+inline MemoryRequest get_fetch_request(const Vrv32_top* rvtop) {
+    MemoryRequest fetch_request;
+    fetch_request.set(rvtop->rv32_top->fetch_request);
+    return fetch_request;
+}
+
+inline uint64_t get_icache_hits(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->icache->hits;
+}
+
+inline uint64_t get_icache_misses(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->icache->misses;
+}
+
 inline MemoryRequest get_memory_request(const Vrv32_top* rvtop) {
     MemoryRequest request;
     request.set(rvtop->mmio_data_request);
@@ -95,6 +121,26 @@ inline uint32_t get_memory_response(const Vrv32_top* rvtop) {
     return rvtop->rv32_top->core_data;
 }
 
+// Access of the instruction in the memory stage, the memory request above
+// is the one of the data cache or the store buffer when they are enabled
+inline MemoryRequest get_mem_stage_request(const Vrv32_top* rvtop) {
+    MemoryRequest request;
+    request.set(rvtop->rv32_top->core->mem_stage->stage_request);
+    return request;
+}
+
+inline uint64_t get_dcache_hits(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->dcache->hits;
+}
+
+inline uint64_t get_dcache_misses(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->dcache->misses;
+}
+
+inline uint64_t get_dcache_writebacks(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->dcache->writebacks;
+}
+
 inline uint8_t get_memory_stall(const Vrv32_top* rvtop) {
     return rvtop->rv32_top->core->mem_stall;
 }
@@ -103,10 +149,118 @@ inline uint8_t get_decode_stall(const Vrv32_top* rvtop) {
     return rvtop->rv32_top->core->dec_stall;
 }
 
+inline uint8_t get_exec_stall(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->exec_stall;
+}
+
 inline uint8_t get_exec_jump(const Vrv32_top* rvtop) {
     return rvtop->rv32_top->core->exec_jump;
 }
 
+inline uint8_t get_decode_jump(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->decode_jump;
+}
+
+inline uint64_t get_branch_predictor_hits(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->branch_predictor->hits;
+}
+
+inline uint64_t get_branch_predictor_misses(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->branch_predictor->misses;
+}
+
+// Decode gets a bubble from fetch the next cycle
+inline uint8_t get_fetch_stall(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->fetch_bubble;
+}
+
+inline uint8_t get_load_use_stall(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->load_use_stall;
+}
+
+inline uint8_t get_mul_use_stall(const Vrv32_top* rvtop) {
+    return rvtop->rv32_top->core->decode_stage->mul_use_stall;
+}
+
+// Tracks if the writeback stage holds a new instruction each cycle
+// The mem/wb buffer keeps its value while the memory stage stalls, so the
+// instruction in writeback is repeated the cycle after a memory stall
+class RetireMonitor {
+  public:
+    bool prev_mem_stall = false;
+    // Writeback repeats the instruction of the previous cycle
+    bool stale = false;
+    bool retired = false;
+
+    // Counters since reset
+    uint64_t cycles = 0;
+    uint64_t instret = 0;
+
+    // Call once per cycle
+    void update(const Vrv32_top* rvtop) {
+        stale = prev_mem_stall;
+        retired = !stale && get_wb_stage_data(rvtop).valid;
+        prev_mem_stall = get_memory_stall(rvtop);
+        cycles++;
+        instret += retired;
+    }
+};
+
+// Shared by all the per cycle monitors, updated by the simulation loop
+static RetireMonitor retire_monitor;
+
+// Memory access and CSR write of the instruction leaving the memory stage,
+// it retires on the next cycle. Call capture after the retire checks of
+// the cycle, accesses match the retired instruction through the pc
+class AccessMonitor {
+  public:
+    struct Access {
+        bool valid = false;
+        uint32_t pc = 0;
+        uint32_t op = 0;
+        uint32_t addr = 0;
+        uint32_t data = 0;
+    };
+    Access mem, csr;
+
+    bool mem_of(uint32_t pc) const { return mem.valid && mem.pc == pc; }
+    bool csr_of(uint32_t pc) const { return csr.valid && csr.pc == pc; }
+
+    void capture(const Vrv32_top* rvtop) {
+        mem.valid = false;
+        csr.valid = false;
+        if (get_memory_stall(rvtop)) return;
+
+        auto mem_data = get_mem_stage_data(rvtop);
+        MemoryRequest request = get_mem_stage_request(rvtop);
+        if (request.op != RV32Types::MEM_NOP) {
+            mem = {true, mem_data.pc, request.op, request.addr, request.data};
+        }
+
+        CSRWriteRequest csrwr = get_csr_write_request(rvtop);
+        if (csrwr.write) {
+            csr = {true, mem_data.pc, 0, csrwr.id, csrwr.value};
+        }
+    }
+};
+
+// PC of the oldest instruction in flight, the one the cycle is spent on
+// If the pipeline only holds bubbles the fetch address is used
+inline uint32_t get_oldest_pc(const Vrv32_top* rvtop, const RetireMonitor& rm) {
+    if (rm.retired) return get_wb_stage_data(rvtop).pc;
+
+    auto mem_data = get_mem_stage_data(rvtop);
+    if (mem_data.valid) return mem_data.pc;
+
+    auto exec_data = get_exec_stage_data(rvtop);
+    if (exec_data.valid) return exec_data.pc;
+
+    auto decode_data = get_decode_stage_data(rvtop);
+    if (decode_data.valid) return decode_data.pc;
+
+    return get_fetch_request(rvtop).addr;
+}
+
 using DissasemblyMap = std::unordered_map<uint32_t, std::string>;
 
 inline DissasemblyMap load_dissasembly(std::string filename) {
@@ -10,7 +10,7 @@
 
 namespace rv32_test {
 
-inline std::string opcode_str(Instruction instr) {
+inline std::string opcode_name(uint32_t opcode) {
     std::string str;
     static const std::unordered_map<RV32Types::valid_opcodes_t, std::string> str_map = {
         {RV32Types::OPCODE_LUI, "LUI"},
@@ -23,14 +23,19 @@ inline std::string opcode_str(Instruction instr) {
         {RV32Types::OPCODE_INTEGER_IMM, "INT IMM"},
         {RV32Types::OPCODE_INTEGER_REG, "INT REG"},
         {RV32Types::OPCODE_ZICSR, "ZICSR"},
-        {RV32Types::OPCODE_BARRIER, "BARRIER"}
+        {RV32Types::OPCODE_BARRIER, "BARRIER"},
+        {RV32Types::OPCODE_GRNG, "GRNG"}
     };
-    auto it = str_map.find(static_cast<RV32Types::valid_opcodes_t>(instr.opcode));
+    auto it = str_map.find(static_cast<RV32Types::valid_opcodes_t>(opcode));
     if (it != str_map.end()) str = it->second;
     else str = "???";
     return str;
 }
 
+inline std::string opcode_str(Instruction instr) {
+    return opcode_name(instr.opcode);
+}
+
 inline std::string bypass_str(Instruction instr, CoreControlSignals dec_instr) {
     static const std::unordered_map<RV32Types::bypass_t, std::string> str_map = {
         {RV32Types::NO_BYPASS, "NO"},
@@ -113,7 +118,7 @@ inline std::string alu_input_str(Instruction instr, CoreControlSignals dec_instr
     return op1 + " " + op2;
 }
 
-inline std::string alu_op_str(CoreControlSignals instr) {
+inline std::string alu_op_name(uint32_t op) {
     std::string str;
     static const std::unordered_map<RV32Types::int_alu_op_t, std::string> str_map = {
         {RV32Types::ALU_OP_ADD, "ADD"},
@@ -127,14 +132,17 @@ inline std::string alu_op_str(CoreControlSignals instr) {
         {RV32Types::ALU_OP_SRA, "SRA"},
         {RV32Types::ALU_OP_SUB, "SUB"}
     };
-    auto it = str_map.find(static_cast<RV32Types::int_alu_op_t>(instr.int_alu_instr.op));
+    auto it = str_map.find(static_cast<RV32Types::int_alu_op_t>(op));
     if (it != str_map.end()) str = it->second;
     else str = "???";
     return str;
 }
 
-// If jump != NOP "[BRANCH_OP]"
-inline std::string branch_op_str(CoreControlSignals instr) {
+inline std::string alu_op_str(CoreControlSignals instr) {
+    return alu_op_name(instr.int_alu_instr.op);
+}
+
+inline std::string branch_op_name(uint32_t op) {
     std::string str;
     static const std::unordered_map<RV32Types::branch_op_t, std::string> str_map = {
         {RV32Types::OP_BEQ, "BEQ"},
@@ -146,9 +154,15 @@ inline std::string branch_op_str(CoreControlSignals instr) {
         {RV32Types::OP_J, "J"},
         {RV32Types::OP_NOP, "NOP"}
     };
-    auto it = str_map.find(static_cast<RV32Types::branch_op_t>(instr.branch_op));
+    auto it = str_map.find(static_cast<RV32Types::branch_op_t>(op));
     if (it != str_map.end()) str = it->second;
     else str = "???";
+    return str;
+}
+
+// If jump != NOP "[BRANCH_OP]"
+inline std::string branch_op_str(CoreControlSignals instr) {
+    std::string str = branch_op_name(instr.branch_op);
     if(str == "NOP") str = "";
     return str;
 }
@@ -200,9 +214,7 @@ inline std::string decode_register_usage_str(const Vrv32_top* rvtop) {
     return s;
 }
 
-inline std::string mem_op_str(const Vrv32_top* rvtop) {
-    MemoryRequest request = get_memory_request(rvtop);
-
+inline std::string mem_op_name(uint32_t op) {
     std::string s = "";
     static const std::unordered_map<RV32Types::mem_op_t, std::string> str_map = {
         {RV32Types::MEM_LB, "LB"},
@@ -215,9 +227,16 @@ inline std::string mem_op_str(const Vrv32_top* rvtop) {
         {RV32Types::MEM_SW, "SW"},
         {RV32Types::MEM_NOP, "NO MEM"}
     };
-    auto it = str_map.find(static_cast<RV32Types::mem_op_t>(request.op));
+    auto it = str_map.find(static_cast<RV32Types::mem_op_t>(op));
     if (it != str_map.end()) s = it->second;
     else s = "???";
+    return s;
+}
+
+inline std::string mem_op_str(const Vrv32_top* rvtop) {
+    MemoryRequest request = get_mem_stage_request(rvtop);
+
+    std::string s = mem_op_name(request.op);
 
     if (s == "NO MEM") s = "";
     else if (s[0] == 'S') {
@@ -277,7 +296,7 @@ class TraceCanvas {
 inline std::string trace_stages(const Vrv32_top* rvtop, const DissasemblyMap& dmap) {
     auto tc = TraceCanvas(5, 6);
 
-    auto instr_request = get_instruction_request(rvtop);
+    auto instr_request = get_fetch_request(rvtop);
 
     tc.canvas[0][0] = 
         std::format("@ {:<#10x} ", instr_request.addr);
@@ -287,7 +306,7 @@ inline std::string trace_stages(const Vrv32_top* rvtop, const DissasemblyMap& dm
     tc.canvas[1][0] = std::format("@ {:<#10x} I {:<#10x}", 
         decode_data.pc, decode_data.instr.get());
     tc.canvas[1][1] = dissasembled_isntr(dmap, decode_data.pc, decode_data.instr.get());
-    if (decode_data.instr.get() != 0x33) {
+    if (decode_data.valid) {
         tc.canvas[1][2] = "Opcode " + opcode_str(decode_data.instr);
         tc.canvas[1][3] = decode_register_usage_str(rvtop);
         tc.canvas[1][4] = bypass_str(decode_data.instr, decode_data.control);
@@ -298,7 +317,7 @@ inline std::string trace_stages(const Vrv32_top* rvtop, const DissasemblyMap& dm
     tc.canvas[2][0] = std::format("@ {:<#10x} I {:<#10x}", 
         exec_data.pc, exec_data.instr.get());
     tc.canvas[2][1] = dissasembled_isntr(dmap, exec_data.pc, exec_data.instr.get());
-    if (exec_data.instr.get() != 0x33) {
+    if (exec_data.valid) {
         tc.canvas[2][2] = wb_src_str(exec_data.instr, exec_data.control);
         tc.canvas[2][3] = alu_op_str(exec_data.control) + " " +
             alu_input_str(exec_data.instr, exec_data.control);
@@ -310,7 +329,7 @@ inline std::string trace_stages(const Vrv32_top* rvtop, const DissasemblyMap& dm
     tc.canvas[3][0] = 
         std::format("@ {:<#10x} I {:<#10x}", mem_data.pc, mem_data.instr.get());
     tc.canvas[3][1] = dissasembled_isntr(dmap, mem_data.pc, mem_data.instr.get());
-    if (mem_data.instr.get() != 0x33) {
+    if (mem_data.valid) {
         tc.canvas[3][2] = wb_src_str(mem_data.instr, mem_data.control);
         tc.canvas[3][3] = mem_op_str(rvtop);
         tc.canvas[3][5] = get_memory_stall(rvtop) == 1 ? "STALL!" : "";
@@ -320,7 +339,7 @@ inline std::string trace_stages(const Vrv32_top* rvtop, const DissasemblyMap& dm
     tc.canvas[4][0] = 
         std::format("@ {:<#10x} I {:<#10x}", wb_data.pc, wb_data.instr.get());
     tc.canvas[4][1] = dissasembled_isntr(dmap, wb_data.pc, wb_data.instr.get());
-    if (wb_data.instr.get() != 0x33) {
+    if (wb_data.valid) {
         tc.canvas[4][2] = wb_write_str(rvtop);
     }
 
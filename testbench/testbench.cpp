@@ -11,11 +11,57 @@
 #include "rv32_test_utils.h"
 #include "rv32_trace_stages.h"
 #include "rv32_memory_utils.h"
+#include "rv32_elf_symbols.h"
+#include "rv32_pc_sampler.h"
+#include "rv32_call_graph.h"
+#include "rv32_pipeline_stats.h"
+#include "rv32_interval_stats.h"
+#include "rv32_instr_mix.h"
+#include "rv32_commit_log.h"
+#include "rv32_cosim.h"
+#include "rv32_fast_forward.h"
+#include "rv32_sampling.h"
+
+// Used by the reports written at exit
+static rv32_test::SymbolTable elf_symbols;
+static rv32_test::DissasemblyMap diassembly_map;
+
+static void write_exit_reports() {
+    rv32_test::write_profiler_timeline();
+    rv32_test::write_profiler_json();
+    rv32_test::write_pc_profile(elf_symbols, diassembly_map);
+    rv32_test::call_graph.write();
+    rv32_test::pipeline_stats.print();
+    rv32_test::pipeline_stats.write_json();
+    rv32_test::pipeline_stats.write_hotspots(elf_symbols, diassembly_map);
+    rv32_test::interval_stats.finish();
+    rv32_test::instr_mix.write();
+    rv32_test::commit_log.close();
+    rv32_test::cosim.print();
+    rv32_test::sampled_simulation.print();
+}
 
 int main(int argc, char** argv) {
 
     std::string rv_elf_executable = "";
     std::string rv_disassembly_file = "";
+    std::string profiler_timeline_file = "";
+    std::string profiler_names_file = "";
+    std::string profiler_json_file = "";
+    std::string sampler_output = "pc_profile";
+    uint64_t sampler_period = 0;
+    std::string call_graph_output = "";
+    bool print_stats = false;
+    std::string stats_json_output = "";
+    std::string hotspots_output = "";
+    uint64_t interval_period = 0;
+    std::string interval_output = "interval_stats.csv";
+    std::string instr_mix_output = "";
+    std::string commit_log_output = "";
+    bool lockstep = false;
+    uint64_t fast_forward_instructions = 0;
+    std::string fast_forward_symbol = "";
+    auto& sampling = rv32_test::sampled_simulation;
 
     constexpr uint64_t max_sim_time = 10000000;
     uint64_t sim_time = 0;
@@ -38,10 +84,114 @@ int main(int argc, char** argv) {
             if (i == argc) break;
             rv_disassembly_file = argv[i];
         }
+        else if (arg == "-pt") {
+            i++;
+            if (i == argc) break;
+            profiler_timeline_file = argv[i];
+        }
+        else if (arg == "-pn") {
+            i++;
+            if (i == argc) break;
+            profiler_names_file = argv[i];
+        }
+        else if (arg == "-pj") {
+            i++;
+            if (i == argc) break;
+            profiler_json_file = argv[i];
+        }
+        else if (arg == "-sp") {
+            i++;
+            if (i == argc) break;
+            sampler_period = std::stoull(argv[i]);
+        }
+        else if (arg == "-so") {
+            i++;
+            if (i == argc) break;
+            sampler_output = argv[i];
+        }
+        else if (arg == "-cg") {
+            i++;
+            if (i == argc) break;
+            call_graph_output = argv[i];
+        }
+        else if (arg == "-cj") {
+            i++;
+            if (i == argc) break;
+            stats_json_output = argv[i];
+        }
+        else if (arg == "-hr") {
+            i++;
+            if (i == argc) break;
+            hotspots_output = argv[i];
+        }
+        else if (arg == "-is") {
+            i++;
+            if (i == argc) break;
+            interval_period = std::stoull(argv[i]);
+        }
+        else if (arg == "-io") {
+            i++;
+            if (i == argc) break;
+            interval_output = argv[i];
+        }
+        else if (arg == "-im") {
+            i++;
+            if (i == argc) break;
+            instr_mix_output = argv[i];
+        }
+        else if (arg == "-cl") {
+            i++;
+            if (i == argc) break;
+            commit_log_output = argv[i];
+        }
+        else if (arg == "-ff") {
+            i++;
+            if (i == argc) break;
+            fast_forward_instructions = std::stoull(argv[i]);
+        }
+        else if (arg == "-fs") {
+            i++;
+            if (i == argc) break;
+            fast_forward_symbol = argv[i];
+        }
+        else if (arg == "-ss") {
+            i++;
+            if (i == argc) break;
+            sampling.period = std::stoull(argv[i]);
+        }
+        else if (arg == "-sw") {
+            i++;
+            if (i == argc) break;
+            sampling.warmup = std::stoull(argv[i]);
+        }
+        else if (arg == "-sm") {
+            i++;
+            if (i == argc) break;
+            sampling.measure = std::stoull(argv[i]);
+        }
+        else if (arg == "-sr") {
+            i++;
+            if (i == argc) break;
+            sampling.random = true;
+            sampling.rng.seed(std::stoull(argv[i]));
+        }
+        else if (arg == "-iw") {
+            i++;
+            if (i == argc) break;
+            rv32_test::instr_wait_states = std::stoul(argv[i]);
+        }
+        else if (arg == "-dw") {
+            i++;
+            if (i == argc) break;
+            rv32_test::data_wait_states = std::stoul(argv[i]);
+        }
+        else if (arg == "-ls") lockstep = true;
+        else if (arg == "-cs") print_stats = true;
         else if (arg == "-t") print_trace = true;
     }
 
-    auto diassembly_map = rv32_test::load_dissasembly(rv_disassembly_file);
+    diassembly_map = rv32_test::load_dissasembly(rv_disassembly_file);
+    elf_symbols = rv32_test::load_symbols(rv_elf_executable);
 
     // Create device under test
     Vrv32_top *dut = new Vrv32_top;
@@ -54,8 +204,49 @@ int main(int argc, char** argv) {
     //m_trace->open("waveform.vcd");
 
     auto rvmem = rv32_test::load_elf(rv_elf_executable);
+    if (lockstep) {
+        rv32_test::cosim.init(rvmem, &elf_symbols, &diassembly_map);
+    }
+    if (fast_forward_instructions != 0 || fast_forward_symbol != "") {
+        rvmem = rv32_test::fast_forward.run(rvmem,
+            fast_forward_instructions, fast_forward_symbol, elf_symbols);
+        if (lockstep) rv32_test::cosim.resume(rv32_test::fast_forward.iss);
+    }
 
     rv32_test::init_profiler_counters();
+    rv32_test::init_profiler_timeline(profiler_timeline_file);
+    rv32_test::load_profiler_region_names(profiler_names_file);
+    rv32_test::init_profiler_json(profiler_json_file);
+    rv32_test::init_pc_sampler(sampler_period, sampler_output);
+    if (call_graph_output != "") {
+        rv32_test::call_graph.init(call_graph_output, &elf_symbols);
+    }
+    if (print_stats || stats_json_output != "") {
+        rv32_test::pipeline_stats.init(print_stats, stats_json_output);
+    }
+    if (hotspots_output != "") {
+        rv32_test::pipeline_stats.init_hotspots(hotspots_output);
+    }
+    if (interval_period != 0) {
+        // Interval rows use the CPI stack categories
+        rv32_test::pipeline_stats.enabled = true;
+        rv32_test::interval_stats.init(interval_period, interval_output,
+            &elf_symbols, &rv32_test::pipeline_stats);
+    }
+    if (instr_mix_output != "") {
+        rv32_test::instr_mix.init(instr_mix_output, &elf_symbols);
+    }
+    if (commit_log_output != "") {
+        rv32_test::commit_log.init(commit_log_output);
+    }
+
+    // Every exit path reaches the reports
+    std::atexit(write_exit_reports);
+
+    // Sampled simulation runs its own RTL models and never returns
+    if (sampling.period != 0) sampling.run(rvmem);
+
+    auto& retire_monitor = rv32_test::retire_monitor;
 
     // Testbench simulation loop
     while (forever || sim_time < max_sim_time) {
@@ -80,6 +271,22 @@ int main(int argc, char** argv) {
         // Update signals
         dut->eval();
 
+        // Per cycle monitors, once per cycle after reset
+        if (!reset_on && dut->clk == 0) {
+            uint64_t cycle = sim_time / 2;
+            retire_monitor.update(dut);
+            // Monitors start once the fast-forward state is restored
+            if (!rv32_test::fast_forward.restoring(dut, retire_monitor)) {
+                rv32_test::pc_sampler_cycle(dut, retire_monitor, cycle);
+                rv32_test::call_graph.cycle(dut, retire_monitor);
+                rv32_test::pipeline_stats.cycle(dut, retire_monitor);
+                rv32_test::interval_stats.cycle(dut, retire_monitor, cycle);
+                rv32_test::instr_mix.cycle(dut, retire_monitor);
+                rv32_test::commit_log.cycle(dut, retire_monitor);
+                rv32_test::cosim.cycle(dut, retire_monitor);
+            }
+        }
+
         // Debug
         // Only on high clk and after reset
         if (print_trace && !reset_on && dut->clk == 0) {